@@ -20,6 +20,7 @@ const int SCREEN_HEIGHT = 720;
 
 const int NUM_CUBES = 4;
 ew::Transform cubeTransforms[NUM_CUBES];
+ew::Vec3 cubeRotations[NUM_CUBES]; //Euler angles (Degrees) edited in the UI
 
 int main() {
 	printf("Initializing...");
@@ -62,8 +63,7 @@ int main() {
 	//Cube positions
 	for (size_t i = 0; i < NUM_CUBES; i++)
 	{
-		cubeTransforms[i].position.x = i % (NUM_CUBES / 2) - 0.5;
-		cubeTransforms[i].position.y = i / (NUM_CUBES / 2) - 0.5;
+		cubeTransforms[i].setPosition(ew::Vec3(i % (NUM_CUBES / 2) - 0.5, i / (NUM_CUBES / 2) - 0.5, 0.0f));
 	}
 
 	while (!glfwWindowShouldClose(window)) {
@@ -95,9 +95,14 @@ int main() {
 			{
 				ImGui::PushID(i);
 				if (ImGui::CollapsingHeader("Transform")) {
-					ImGui::DragFloat3("Position", &cubeTransforms[i].position.x, 0.05f);
-					ImGui::DragFloat3("Rotation", &cubeTransforms[i].rotation.x, 1.0f);
-					ImGui::DragFloat3("Scale", &cubeTransforms[i].scale.x, 0.05f);
+					ew::Vec3 position = cubeTransforms[i].getPosition();
+					ew::Vec3 scale = cubeTransforms[i].getScale();
+					if (ImGui::DragFloat3("Position", &position.x, 0.05f))
+						cubeTransforms[i].setPosition(position);
+					if (ImGui::DragFloat3("Rotation", &cubeRotations[i].x, 1.0f))
+						cubeTransforms[i].setEulerRotation(cubeRotations[i]);
+					if (ImGui::DragFloat3("Scale", &scale.x, 0.05f))
+						cubeTransforms[i].setScale(scale);
 				}
 				ImGui::PopID();
 			}
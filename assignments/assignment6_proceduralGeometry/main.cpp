@@ -14,6 +14,7 @@
 #include <ew/transform.h>
 #include <ew/camera.h>
 #include <ew/cameraController.h>
+#include <ew/meshCache.h>
 
 #include "akcGPR/procGen.h"
 
@@ -37,6 +38,10 @@ struct AppSettings {
 
 	//Euler angles (degrees)
 	ew::Vec3 lightRotation = ew::Vec3(0, 0, 0);
+
+	int planeSubdivisions = 5;
+	int cylinderSegments = 15;
+	int sphereSegments = 15;
 }appSettings;
 
 ew::Camera camera;
@@ -81,32 +86,43 @@ int main() {
 	unsigned int brickTexture = ew::loadTexture("assets/brick_color.jpg",GL_REPEAT,GL_LINEAR);
 
 	//Create cube
-	ew::MeshData cubeMeshData = ew::createCube(0.5f);
-	ew::Mesh cubeMesh(cubeMeshData);
+	ew::Mesh cubeMesh(ew::createCube(0.5f));
 
 	ew::Transform cubeTransform;
-	cubeTransform.position = ew::Vec3(-2.0, 0.0, 0.0);
+	cubeTransform.setPosition(ew::Vec3(-2.0, 0.0, 0.0));
+
+	//Shapes come from a cache, so going back to earlier settings reuses the meshes generated for them
+	ew::MeshCache meshCache;
+	auto getPlane = [&]() {
+		return meshCache.get(ew::MeshCache::makeKey("akcGPR::plane", { 1.0f, 2.0f, (float)appSettings.planeSubdivisions }),
+			[]() { return akcGPR::createPlane(1.0, 2.0, appSettings.planeSubdivisions); });
+	};
+	auto getCylinder = [&]() {
+		return meshCache.get(ew::MeshCache::makeKey("akcGPR::cylinder", { 2.0f, 0.5f, (float)appSettings.cylinderSegments }),
+			[]() { return akcGPR::createCylinder(2.0, 0.5, appSettings.cylinderSegments); });
+	};
+	auto getSphere = [&]() {
+		return meshCache.get(ew::MeshCache::makeKey("akcGPR::sphere", { 0.5f, (float)appSettings.sphereSegments }),
+			[]() { return akcGPR::createSphere(0.5, appSettings.sphereSegments); });
+	};
 
 	// create plane
-	ew::MeshData planeMeshData = akcGPR::createPlane(1.0, 2.0, 5);
-	ew::Mesh planeMesh(planeMeshData);
+	std::shared_ptr<ew::Mesh> planeMesh = getPlane();
 
 	ew::Transform planeTransform;
-	planeTransform.position = ew::Vec3(-1.5, -0.5, 1.0);
+	planeTransform.setPosition(ew::Vec3(-1.5, -0.5, 1.0));
 
 	// create cylinder
-	ew::MeshData cylinderMeshData = akcGPR::createCylinder(2.0, 0.5, 15);
-	ew::Mesh cylinderMesh(cylinderMeshData);
+	std::shared_ptr<ew::Mesh> cylinderMesh = getCylinder();
 
 	ew::Transform cylinderTransform;
-	cylinderTransform.position = ew::Vec3(0.25, 0.0, 0.0);
+	cylinderTransform.setPosition(ew::Vec3(0.25, 0.0, 0.0));
 
 	// create sphere
-	ew::MeshData sphereMeshData = akcGPR::createSphere(0.5, 15);
-	ew::Mesh sphereMesh(sphereMeshData);
+	std::shared_ptr<ew::Mesh> sphereMesh = getSphere();
 
 	ew::Transform sphereTransform;
-	sphereTransform.position = ew::Vec3(1.5, 0.0, 0.0);
+	sphereTransform.setPosition(ew::Vec3(1.5, 0.0, 0.0));
 
 	resetCamera(camera,cameraController);
 
@@ -144,15 +160,15 @@ int main() {
 
 		// draw plane
 		shader.setMat4("_Model", planeTransform.getModelMatrix());
-		planeMesh.draw((ew::DrawMode)appSettings.drawAsPoints);
+		planeMesh->draw((ew::DrawMode)appSettings.drawAsPoints);
 
 		// draw cylinder
 		shader.setMat4("_Model", cylinderTransform.getModelMatrix());
-		cylinderMesh.draw((ew::DrawMode)appSettings.drawAsPoints);
+		cylinderMesh->draw((ew::DrawMode)appSettings.drawAsPoints);
 
 		// draw sphere
 		shader.setMat4("_Model", sphereTransform.getModelMatrix());
-		sphereMesh.draw((ew::DrawMode)appSettings.drawAsPoints);
+		sphereMesh->draw((ew::DrawMode)appSettings.drawAsPoints);
 
 		//Render UI
 		{
@@ -186,6 +202,17 @@ int main() {
 			if (appSettings.shadingModeIndex > 3) {
 				ImGui::DragFloat3("Light Rotation", &appSettings.lightRotation.x, 1.0f);
 			}
+			if (ImGui::CollapsingHeader("Shapes")) {
+				if (ImGui::SliderInt("Plane subdivisions", &appSettings.planeSubdivisions, 1, 64))
+					planeMesh = getPlane();
+				if (ImGui::SliderInt("Cylinder segments", &appSettings.cylinderSegments, 3, 128))
+					cylinderMesh = getCylinder();
+				if (ImGui::SliderInt("Sphere segments", &appSettings.sphereSegments, 2, 128))
+					sphereMesh = getSphere();
+				const ew::MeshCacheStats& cacheStats = meshCache.getStats();
+				ImGui::Text("Mesh cache: %d meshes, %.1f KB", (int)cacheStats.numMeshes, cacheStats.bytes / 1024.0f);
+				ImGui::Text("Hits: %d  Misses: %d  Evictions: %d", (int)cacheStats.hits, (int)cacheStats.misses, (int)cacheStats.evictions);
+			}
 			ImGui::Checkbox("Draw as points", &appSettings.drawAsPoints);
 			if (ImGui::Checkbox("Wireframe", &appSettings.wireframe)) {
 				glPolygonMode(GL_FRONT_AND_BACK, appSettings.wireframe ? GL_LINE : GL_FILL);
@@ -5,6 +5,7 @@ in Surface{
 	vec2 UV;
 	vec3 worldPos;
 	vec3 worldNormal;
+	vec3 tint;
 }fs_in;
 
 uniform sampler2D _Texture;
@@ -27,7 +28,7 @@ uniform Material _Material;
 
 void main(){
     vec3 normal = normalize(fs_in.worldNormal);
-    vec4 color = texture(_Texture, fs_in.UV);
+    vec4 color = texture(_Texture, fs_in.UV) * vec4(fs_in.tint, 1.0);
 
 	vec3 lightColor = vec3(0.0);
 
@@ -2,26 +2,46 @@
 layout(location = 0) in vec3 vPos;
 layout(location = 1) in vec3 vNormal;
 layout(location = 2) in vec2 vUV;
+// per instance data (ew::InstanceData), used for instanced and ew::MeshPool draws
+layout(location = 3) in mat4 iModel;
+layout(location = 7) in mat4 iNormalMatrix;
+layout(location = 11) in vec4 iColor;
 
 out Surface{
 	vec2 UV;
 	vec3 worldPos;
 	vec3 worldNormal;
+	vec3 tint;
 }vs_out;
 
 uniform mat4 _Model;
+uniform mat4 _NormalMatrix; // inverse transpose of _Model, computed on the CPU
 uniform mat4 _ViewProjection;
+uniform bool _UseInstanceData; // read the matrices from the instance attributes instead of the uniforms
+uniform bool _OctahedralNormals; // true for quantized meshes, where vNormal.xy holds an octahedral encoded normal
+
+vec3 decodeOctahedral(vec2 e){
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
 
 void main(){
 	vs_out.UV = vUV;
 
+	mat4 model = _UseInstanceData ? iModel : _Model;
+	mat4 normalMatrix = _UseInstanceData ? iNormalMatrix : _NormalMatrix;
+	vs_out.tint = _UseInstanceData ? iColor.rgb : vec3(1.0);
+
 	// converts vertex position to world space
-	vec4 tempPos = _Model * vec4(vPos, 1.0);
+	vec4 tempPos = model * vec4(vPos, 1.0);
 	vs_out.worldPos = tempPos.xyz;
 
 	// converts vertex normal to world space
-	vs_out.worldNormal = transpose(inverse(mat3(_Model))) * vNormal;
-	// mat3(transpose(inverse(_Model))) also gives correct normal matrix
+	vec3 normal = _OctahedralNormals ? decodeOctahedral(vNormal.xy) : vNormal;
+	vs_out.worldNormal = mat3(normalMatrix) * normal;
 
-	gl_Position = _ViewProjection * _Model * vec4(vPos,1.0);
+	gl_Position = _ViewProjection * tempPos;
 }
\ No newline at end of file
@@ -2,8 +2,8 @@
 #version 450
 out vec4 FragColor;
 
-uniform vec3 _Color;
+in vec3 Color;
 
 void main(){
-	FragColor = vec4(_Color,1.0);
+	FragColor = vec4(Color,1.0);
 }
\ No newline at end of file
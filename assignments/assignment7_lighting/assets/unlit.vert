@@ -3,10 +3,19 @@
 layout(location = 0) in vec3 vPos;
 layout(location = 1) in vec3 vNormal;
 layout(location = 2) in vec2 vUV;
+// per instance data (ew::InstanceData)
+layout(location = 3) in mat4 iModel;
+layout(location = 11) in vec4 iColor;
+
+out vec3 Color;
 
 uniform mat4 _Model;
 uniform mat4 _ViewProjection;
+uniform vec3 _Color;
+uniform bool _UseInstanceData; // read model and color from the instance attributes instead of the uniforms
 
 void main(){
-	gl_Position = _ViewProjection * _Model * vec4(vPos,1.0);
+	mat4 model = _UseInstanceData ? iModel : _Model;
+	Color = _UseInstanceData ? iColor.rgb : _Color;
+	gl_Position = _ViewProjection * model * vec4(vPos,1.0);
 }
\ No newline at end of file
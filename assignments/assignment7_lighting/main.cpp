@@ -1,8 +1,11 @@
 #include <stdio.h>
 #include <math.h>
+#include <ctype.h>
+#include <string>
 
 #include <ew/external/glad.h>
 #include <ew/ewMath/ewMath.h>
+#include <ew/ewMath/frustum.h>
 #include <GLFW/glfw3.h>
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -11,6 +14,15 @@
 #include <ew/shader.h>
 #include <ew/texture.h>
 #include <ew/procGen.h>
+#include <ew/meshOptimize.h>
+#include <ew/meshSimplify.h>
+#include <ew/meshLod.h>
+#include <ew/meshlet.h>
+#include <ew/meshFile.h>
+#include <ew/dynamicMesh.h>
+#include <ew/meshPool.h>
+#include <ew/meshCache.h>
+#include <ew/terrain.h>
 #include <ew/transform.h>
 #include <ew/camera.h>
 #include <ew/cameraController.h>
@@ -75,20 +87,36 @@ int main() {
 	ew::Shader shader("assets/defaultLit.vert", "assets/defaultLit.frag");
 	unsigned int brickTexture = ew::loadTexture("assets/brick_color.jpg",GL_REPEAT,GL_LINEAR);
 
-	//Create cube
-	ew::Mesh cubeMesh(ew::createCube(1.0f));
-	ew::Mesh planeMesh(ew::createPlane(5.0f, 5.0f, 10));
-	ew::Mesh sphereMesh(ew::createSphere(0.5f, 64));
-	ew::Mesh cylinderMesh(ew::createCylinder(0.5f, 1.0f, 32));
+	//Create shapes through the cache, so anything asking for the same shape later shares these meshes.
+	//The meshes keep their MeshData for the quantized copies, the mesh pool and the sphere LODs
+	ew::MeshCache meshCache;
+	//Reorder triangles and vertices for the post-transform cache before uploading
+	auto optimized = [](const char* name, ew::MeshData meshData) {
+		ew::MeshOptimizeReport report = ew::optimizeMesh(meshData);
+		printf("\n%s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", name, report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr);
+		return meshData;
+	};
+	std::shared_ptr<ew::Mesh> cubeMeshPtr = meshCache.get(ew::MeshCache::makeKey("ew::cube+optimized", { 1.0f }),
+		[&]() { return optimized("Cube", ew::createCube(1.0f)); }, true);
+	std::shared_ptr<ew::Mesh> planeMeshPtr = meshCache.get(ew::MeshCache::makeKey("ew::plane+optimized", { 5.0f, 5.0f, 10 }),
+		[&]() { return optimized("Plane", ew::createPlane(5.0f, 5.0f, 10)); }, true);
+	std::shared_ptr<ew::Mesh> sphereMeshPtr = meshCache.get(ew::MeshCache::makeKey("ew::sphere+optimized", { 0.5f, 64 }),
+		[&]() { return optimized("Sphere", ew::createSphere(0.5f, 64)); }, true);
+	std::shared_ptr<ew::Mesh> cylinderMeshPtr = meshCache.get(ew::MeshCache::makeKey("ew::cylinder+optimized", { 0.5f, 1.0f, 32 }),
+		[&]() { return optimized("Cylinder", ew::createCylinder(0.5f, 1.0f, 32)); }, true);
+	ew::Mesh& cubeMesh = *cubeMeshPtr;
+	ew::Mesh& planeMesh = *planeMeshPtr;
+	ew::Mesh& sphereMesh = *sphereMeshPtr;
+	ew::Mesh& cylinderMesh = *cylinderMeshPtr;
 
 	//Initialize transforms
 	ew::Transform cubeTransform;
 	ew::Transform planeTransform;
 	ew::Transform sphereTransform;
 	ew::Transform cylinderTransform;
-	planeTransform.position = ew::Vec3(0, -1.0, 0);
-	sphereTransform.position = ew::Vec3(-1.5f, 0.0f, 0.0f);
-	cylinderTransform.position = ew::Vec3(1.5f, 0.0f, 0.0f);
+	planeTransform.setPosition(ew::Vec3(0, -1.0, 0));
+	sphereTransform.setPosition(ew::Vec3(-1.5f, 0.0f, 0.0f));
+	cylinderTransform.setPosition(ew::Vec3(1.5f, 0.0f, 0.0f));
 
 	// create lights
 	const int MAX_LIGHTS = 4; // make sure this is the same in frag shader as well
@@ -106,7 +134,28 @@ int main() {
 	lights[3].color = ew::Vec3(1.0f, 1.0f, 0.0f);
 
 	ew::Shader unlitShader("assets/unlit.vert", "assets/unlit.frag");
-	ew::Mesh lightSphereMesh(ew::createSphere(0.25f, 16));
+	//Loaded from a mesh file when one exists, generated and saved otherwise
+	ew::Mesh lightSphereMesh;
+	{
+		//The file is named after the generator and its parameters, so changing them writes a new file
+		const float lightSphereRadius = 0.25f;
+		const int lightSphereSubdivisions = 16;
+		std::string lightSphereName = ew::MeshCache::makeKey("ew::sphere", { lightSphereRadius, (float)lightSphereSubdivisions });
+		for (char& c : lightSphereName) {
+			if (!isalnum((unsigned char)c) && c != '.' && c != ',')
+				c = '_'; //"ew::sphere(0.25,16)" -> "ew__sphere_0.25,16_"
+		}
+		const std::string lightSpherePath = "assets/" + lightSphereName + ".emsh";
+		ew::MeshFile lightSphereFile;
+		if (lightSphereFile.open(lightSpherePath.c_str())) {
+			lightSphereFile.upload(lightSphereMesh);
+		}
+		else {
+			ew::MeshData lightSphereData = ew::createSphere(lightSphereRadius, lightSphereSubdivisions);
+			ew::writeMeshFile(lightSpherePath.c_str(), lightSphereData);
+			lightSphereMesh.load(std::move(lightSphereData));
+		}
+	}
 	ew::Transform lightSphereTransform;
 
 	// create material
@@ -118,6 +167,64 @@ int main() {
 
 	resetCamera(camera,cameraController);
 
+	//Objects tested for frustum culling. Index order: cube, plane, sphere, cylinder, then lights
+	const int NUM_SHAPES = 4;
+	const int NUM_CULLABLES = NUM_SHAPES + MAX_LIGHTS;
+	ew::Mesh* shapeMeshes[NUM_SHAPES] = { &cubeMesh, &planeMesh, &sphereMesh, &cylinderMesh };
+	ew::Transform* shapeTransforms[NUM_SHAPES] = { &cubeTransform, &planeTransform, &sphereTransform, &cylinderTransform };
+	const ew::MeshData* shapeMeshData[NUM_SHAPES] = { cubeMesh.getMeshData(), planeMesh.getMeshData(), sphereMesh.getMeshData(), cylinderMesh.getMeshData() };
+	bool quantizedMeshes = false;
+	//Cached meshes are shared, so the quantized versions are separate meshes owned here
+	ew::Mesh quantizedShapeMeshes[NUM_SHAPES];
+
+	//Simplified levels of the sphere, picked by screen size
+	const int SPHERE_INDEX = 2;
+	ew::MeshLodSet sphereLods(ew::createLodChain(*sphereMesh.getMeshData(), { 0.5f, 0.25f, 0.1f }));
+	bool sphereLod = true;
+	int sphereLevel = 0;
+
+	//Full detail sphere split into meshlets, so back facing and off screen clusters can be skipped
+	ew::MeshData sphereMeshletData = *sphereMesh.getMeshData();
+	std::vector<ew::Meshlet> sphereMeshlets = ew::buildMeshlets(sphereMeshletData);
+	ew::Mesh sphereMeshletMesh(std::move(sphereMeshletData));
+	std::vector<unsigned char> sphereMeshletVisible(sphereMeshlets.size());
+	std::vector<ew::DrawElementsIndirectCommand> sphereMeshletCommands;
+	ew::MeshletCullStats sphereMeshletStats;
+	bool meshletCulling = false;
+
+	//Wavy version of the plane, rewritten by the CPU every frame
+	const int PLANE_INDEX = 1;
+	const ew::MeshData& flatPlaneData = *planeMesh.getMeshData();
+	ew::DynamicMesh wavePlaneMesh(flatPlaneData.vertices.size(), flatPlaneData.indices.size());
+	wavePlaneMesh.update(flatPlaneData);
+	std::vector<ew::Vertex> waveVertices = flatPlaneData.vertices;
+	bool animatePlane = false;
+
+	//The same shapes packed into one pool, drawn with a single multi-draw call
+	ew::MeshPool shapePool(65536, 262144);
+	int pooledShapes[NUM_SHAPES];
+	for (int i = 0; i < NUM_SHAPES; i++)
+		pooledShapes[i] = shapePool.add(*shapeMeshData[i]);
+	bool pooledDraw = false;
+	int visibleShapes[NUM_SHAPES];
+	ew::InstanceData shapeInstances[NUM_SHAPES];
+	ew::InstanceData lightInstances[MAX_LIGHTS];
+	int drawCalls = 0;
+	float cullX[NUM_CULLABLES], cullY[NUM_CULLABLES], cullZ[NUM_CULLABLES], cullRadius[NUM_CULLABLES];
+	unsigned char visible[NUM_CULLABLES];
+	bool frustumCulling = true;
+
+	//Streamed hills below the shapes, scaled down to the size of the scene
+	ew::TerrainSettings terrainSettings;
+	terrainSettings.chunkSize = 8.0f;
+	terrainSettings.chunkResolution = 32;
+	terrainSettings.lodDistance = 12.0f;
+	terrainSettings.viewDistance = 96.0f;
+	ew::Terrain terrain(terrainSettings, [](float x, float z) {
+		return ew::TerrainNoise(x / 32.0f, z / 32.0f, 1, 5) * 3.0f - 4.0f;
+	});
+	bool showTerrain = false;
+
 	while (!glfwWindowShouldClose(window)) {
 		glfwPollEvents();
 
@@ -133,10 +240,39 @@ int main() {
 		glClearColor(bgColor.x, bgColor.y,bgColor.z,1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+		const ew::Mat4 viewProjection = camera.ProjectionMatrix() * camera.ViewMatrix();
+
+		//Frustum culling. Gather world space bounding spheres and test them all at once
+		for (int i = 0; i < NUM_SHAPES; i++) {
+			const ew::Bounds& bounds = shapeMeshes[i]->getBounds();
+			const ew::Vec3& scale = shapeTransforms[i]->getScale();
+			const ew::Vec4 center = shapeTransforms[i]->getModelMatrix() * ew::Vec4(bounds.center, 1.0f);
+			cullX[i] = center.x;
+			cullY[i] = center.y;
+			cullZ[i] = center.z;
+			cullRadius[i] = bounds.radius * fmaxf(fabsf(scale.x), fmaxf(fabsf(scale.y), fabsf(scale.z)));
+		}
+		for (int i = 0; i < activeLights; i++) {
+			cullX[NUM_SHAPES + i] = lights[i].position.x;
+			cullY[NUM_SHAPES + i] = lights[i].position.y;
+			cullZ[NUM_SHAPES + i] = lights[i].position.z;
+			cullRadius[NUM_SHAPES + i] = lightSphereMesh.getBounds().radius;
+		}
+		const int numCullables = NUM_SHAPES + activeLights;
+		int numVisible = numCullables;
+		if (frustumCulling) {
+			ew::Frustum frustum = ew::ExtractFrustum(viewProjection);
+			numVisible = (int)ew::CullSpheres(frustum, cullX, cullY, cullZ, cullRadius, numCullables, visible);
+		}
+		else {
+			for (int i = 0; i < numCullables; i++)
+				visible[i] = 1;
+		}
+
 		shader.use();
 		glBindTexture(GL_TEXTURE_2D, brickTexture);
 		shader.setInt("_Texture", 0);
-		shader.setMat4("_ViewProjection", camera.ProjectionMatrix() * camera.ViewMatrix());
+		shader.setMat4("_ViewProjection", viewProjection);
 
 		shader.setFloat("_Material.ambientK", material.ambientK);
 		shader.setFloat("_Material.diffuseK", material.diffuseK);
@@ -164,32 +300,93 @@ int main() {
 		}
 		
 		//Draw shapes
-		shader.setMat4("_Model", cubeTransform.getModelMatrix());
-		cubeMesh.draw();
-
-		shader.setMat4("_Model", planeTransform.getModelMatrix());
-		planeMesh.draw();
-
-		shader.setMat4("_Model", sphereTransform.getModelMatrix());
-		sphereMesh.draw();
+		drawCalls = 0;
+		if (pooledDraw) {
+			int numDraws = 0;
+			for (int i = 0; i < NUM_SHAPES; i++) {
+				if (!visible[i])
+					continue;
+				visibleShapes[numDraws] = pooledShapes[i];
+				shapeInstances[numDraws].model = shapeTransforms[i]->getModelMatrix();
+				shapeInstances[numDraws].normalMatrix = shapeTransforms[i]->getNormalMatrix();
+				numDraws++;
+			}
+			shader.setInt("_UseInstanceData", 1);
+			shader.setInt("_OctahedralNormals", 0);
+			shapePool.draw(visibleShapes, shapeInstances, numDraws);
+			shader.setInt("_UseInstanceData", 0);
+			drawCalls++;
+		}
+		else {
+			for (int i = 0; i < NUM_SHAPES; i++) {
+				if (!visible[i])
+					continue;
+				drawCalls++;
+				shader.setMat4("_NormalMatrix", shapeTransforms[i]->getNormalMatrix());
+				if (i == PLANE_INDEX && animatePlane) {
+					//y = A * sin(kx + t)
+					const float amplitude = 0.2f, frequency = 2.0f;
+					for (size_t v = 0; v < waveVertices.size(); v++) {
+						const float x = flatPlaneData.vertices[v].pos.x;
+						waveVertices[v].pos.y = amplitude * sinf(frequency * x + time);
+						waveVertices[v].normal = ew::Normalize(ew::Vec3(-amplitude * frequency * cosf(frequency * x + time), 1.0f, 0.0f));
+					}
+					wavePlaneMesh.updateVertices(0, waveVertices.data(), waveVertices.size());
+					shader.setMat4("_Model", shapeTransforms[i]->getModelMatrix());
+					shader.setInt("_OctahedralNormals", 0);
+					wavePlaneMesh.draw();
+					continue;
+				}
+				if (i == SPHERE_INDEX && meshletCulling && !quantizedMeshes) {
+					const ew::Mat4 model = shapeTransforms[i]->getModelMatrix();
+					sphereMeshletStats = ew::cullMeshlets(sphereMeshlets, viewProjection, model, camera.position, sphereMeshletVisible.data());
+					ew::buildMeshletCommands(sphereMeshlets, sphereMeshletVisible.data(), sphereMeshletCommands);
+					shader.setMat4("_Model", model);
+					shader.setInt("_OctahedralNormals", 0);
+					sphereMeshletMesh.drawIndirect(sphereMeshletCommands.data(), (int)sphereMeshletCommands.size());
+					continue;
+				}
+				if (i == SPHERE_INDEX && sphereLod && !quantizedMeshes) {
+					sphereLevel = sphereLods.selectLod(camera, shapeTransforms[i]->getModelMatrix());
+					shader.setMat4("_Model", shapeTransforms[i]->getModelMatrix());
+					shader.setInt("_OctahedralNormals", 0);
+					sphereLods.draw(sphereLevel);
+					continue;
+				}
+				const ew::Mesh& mesh = quantizedMeshes ? quantizedShapeMeshes[i] : *shapeMeshes[i];
+				shader.setMat4("_Model", shapeTransforms[i]->getModelMatrix() * mesh.getDequantizeMatrix());
+				shader.setInt("_OctahedralNormals", mesh.isQuantized());
+				mesh.draw();
+			}
+		}
 
-		shader.setMat4("_Model", cylinderTransform.getModelMatrix());
-		cylinderMesh.draw();
+		if (showTerrain) {
+			terrain.update(camera);
+			shader.setMat4("_Model", ew::IdentityMatrix());
+			shader.setMat4("_NormalMatrix", ew::IdentityMatrix());
+			shader.setInt("_OctahedralNormals", 0);
+			drawCalls += terrain.draw(viewProjection);
+		}
 
-		// Render point lights
+		// Render point lights, all visible ones in one instanced draw
 		unlitShader.use();
-		unlitShader.setMat4("_ViewProjection", camera.ProjectionMatrix() * camera.ViewMatrix());
+		unlitShader.setMat4("_ViewProjection", viewProjection);
+		int numLightInstances = 0;
 		for(int i = 0; i < activeLights; i++)
 		{
-			std::string lightsPosString = "_Lights[" + i;
-			lightsPosString = lightsPosString + "].position";
-			std::string lightsColString = "_Lights[" + i;
-			lightsColString = lightsColString + "].color";
-
-			lightSphereTransform.position = lights[i].position;
-			unlitShader.setMat4("_Model", lightSphereTransform.getModelMatrix());
-			unlitShader.setVec3("_Color", lights[i].color);
-			lightSphereMesh.draw();
+			if (!visible[NUM_SHAPES + i])
+				continue;
+			lightSphereTransform.setPosition(lights[i].position);
+			lightInstances[numLightInstances].model = lightSphereTransform.getModelMatrix() * lightSphereMesh.getDequantizeMatrix();
+			lightInstances[numLightInstances].color = ew::Vec4(lights[i].color, 1.0f);
+			numLightInstances++;
+		}
+		if (numLightInstances > 0) {
+			lightSphereMesh.setInstances(lightInstances, numLightInstances);
+			unlitShader.setInt("_UseInstanceData", 1);
+			lightSphereMesh.drawInstanced(numLightInstances);
+			unlitShader.setInt("_UseInstanceData", 0);
+			drawCalls++;
 		}
 
 		//Render UI
@@ -202,6 +399,32 @@ int main() {
 
 			ImGui::ColorEdit3("BG color", &bgColor.x);
 			ImGui::DragInt("Active Lights", &activeLights, 0.1f, 0, MAX_LIGHTS);
+			ImGui::Checkbox("Frustum Culling", &frustumCulling);
+			ImGui::Text("Visible: %d  Culled: %d", numVisible, numCullables - numVisible);
+			ImGui::Checkbox("Pooled Draw", &pooledDraw);
+			ImGui::Text("Draw calls: %d", drawCalls);
+			ImGui::Text("Mesh cache: %d meshes, %d hits, %d misses", (int)meshCache.getStats().numMeshes, (int)meshCache.getStats().hits, (int)meshCache.getStats().misses);
+			ImGui::Checkbox("Terrain", &showTerrain);
+			if (showTerrain)
+				ImGui::Text("Terrain: %d chunks, %d pending, %.1f MB", terrain.getNumLoadedChunks(), terrain.getNumPendingChunks(), terrain.getMemoryUsage() / (1024.0f * 1024.0f));
+			ImGui::Checkbox("Animate Plane", &animatePlane);
+			ImGui::Checkbox("Sphere Meshlet Culling", &meshletCulling);
+			if (meshletCulling) {
+				ImGui::Text("Meshlets: %d visible, %d off screen, %d back facing", (int)sphereMeshletStats.visible,
+					(int)sphereMeshletStats.frustumCulled, (int)sphereMeshletStats.backfaceCulled);
+			}
+			ImGui::Checkbox("Sphere LOD", &sphereLod);
+			if (sphereLod) {
+				ImGui::Text("Sphere LOD %d: %d triangles", sphereLevel, sphereLods.getLod(sphereLevel).getNumIndices() / 3);
+			}
+			if (ImGui::Checkbox("Quantized Vertices", &quantizedMeshes)) {
+				for (int i = 0; i < NUM_SHAPES; i++) {
+					if (quantizedMeshes)
+						quantizedShapeMeshes[i].load(ew::quantizeMesh(*shapeMeshData[i]));
+					else
+						quantizedShapeMeshes[i] = ew::Mesh();
+				}
+			}
 
 			if (ImGui::CollapsingHeader("Camera")) {
 				ImGui::DragFloat3("Position", &camera.position.x, 0.1f);
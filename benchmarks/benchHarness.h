@@ -0,0 +1,75 @@
+#pragma once
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+//Minimal micro-benchmark harness shared by the benchmark targets.
+//Each benchmark runs a number of warmup batches, then times `repetitions` batches of `batchSize` calls.
+//Per-batch ns/op samples are reduced to median and p99.
+namespace bench {
+	struct Result {
+		const char* name = "";
+		double medianNs = 0;
+		double p99Ns = 0;
+		double minNs = 0;
+	};
+
+	struct Settings {
+		int batchSize = 1024; //Calls per timed sample
+		int warmup = 20; //Untimed batches before sampling
+		int repetitions = 200; //Timed batches
+	};
+
+	//Keeps the compiler from discarding a computed value
+	template<typename T>
+	inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile char sink;
+		sink = *reinterpret_cast<const volatile char*>(&value);
+#endif
+	}
+
+	//Times fn(i) for i in [0, batchSize). fn should pass its result to doNotOptimize.
+	template<typename Fn>
+	Result run(const char* name, Fn&& fn, const Settings& settings = Settings()) {
+		for (int w = 0; w < settings.warmup; w++)
+			for (int i = 0; i < settings.batchSize; i++)
+				fn(i);
+
+		std::vector<double> samples(settings.repetitions);
+		for (int r = 0; r < settings.repetitions; r++) {
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < settings.batchSize; i++)
+				fn(i);
+			auto end = std::chrono::steady_clock::now();
+			samples[r] = std::chrono::duration<double, std::nano>(end - start).count() / settings.batchSize;
+		}
+		std::sort(samples.begin(), samples.end());
+
+		Result result;
+		result.name = name;
+		result.medianNs = samples[samples.size() / 2];
+		result.p99Ns = samples[std::min(samples.size() - 1, (samples.size() * 99) / 100)];
+		result.minNs = samples.front();
+		return result;
+	}
+
+	inline void printHeader(const char* title) {
+		printf("\n%s\n", title);
+		printf("%-36s %12s %12s %12s\n", "benchmark", "median ns/op", "p99 ns/op", "min ns/op");
+	}
+
+	inline void print(const Result& r) {
+		printf("%-36s %12.2f %12.2f %12.2f\n", r.name, r.medianNs, r.p99Ns, r.minNs);
+	}
+
+	//Prints both results and the median ratio baseline / candidate (>1 means candidate is faster)
+	inline void printComparison(const Result& candidate, const Result& baseline) {
+		print(candidate);
+		print(baseline);
+		printf("%-36s %11.2fx\n", "  speedup (median)", baseline.medianNs / candidate.medianNs);
+	}
+}
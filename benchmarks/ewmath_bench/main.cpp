@@ -0,0 +1,298 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <ew/ewMath/ewMath.h>
+#include <ew/ewMath/transformations.h>
+#include <ew/ewMath/batch.h>
+#include <ew/ewMath/frustum.h>
+#include <ew/camera.h>
+#include <ew/transform.h>
+#include <akcGPR/transformations.h>
+
+#include "benchHarness.h"
+
+//Compile-time checks: each of these must fold to a constant or the build fails
+namespace constexprChecks {
+	constexpr bool nearlyEqual(float a, float b, float epsilon = 1e-5f) {
+		return (a - b) < epsilon && (b - a) < epsilon;
+	}
+	static_assert(ew::Dot(ew::Vec3(1, 2, 3), ew::Vec3(4, 5, 6)) == 32.0f, "Dot");
+	static_assert(ew::Cross(ew::Vec3(1, 0, 0), ew::Vec3(0, 1, 0)).z == 1.0f, "Cross");
+	static_assert(nearlyEqual(ew::Magnitude(ew::Vec3(3, 4, 0)), 5.0f), "Magnitude");
+	static_assert(nearlyEqual(ew::Normalize(ew::Vec2(0, 2)).y, 1.0f), "Normalize");
+	static_assert(nearlyEqual(ew::Sin(ew::PI / 6), 0.5f), "Sin");
+	static_assert(nearlyEqual(ew::Cos(ew::PI / 3), 0.5f), "Cos");
+	static_assert(nearlyEqual(ew::Sin(-7.0f), -0.6569866f), "Sin range reduction");
+	static_assert(nearlyEqual(ew::Sqrt(2.0f), 1.4142135f), "Sqrt");
+
+	constexpr ew::Mat4 TRS = ew::Translate(ew::Vec3(1, 2, 3)) * ew::RotateY(ew::Radians(90)) * ew::Scale(ew::Vec3(2));
+	static_assert(TRS[3][0] == 1.0f && TRS[3][1] == 2.0f && TRS[3][2] == 3.0f, "Translate");
+	static_assert(nearlyEqual((TRS * ew::Vec4(1, 0, 0, 1)).z, 1.0f), "RotateY * Scale");
+	static_assert(ew::Identity()[2][2] == 1.0f && ew::Identity()[2][1] == 0.0f, "Identity");
+	static_assert(nearlyEqual((ew::Inverse(TRS) * TRS)[1][1], 1.0f), "Inverse");
+	static_assert(nearlyEqual((ew::InverseAffine(TRS) * TRS)[0][0], 1.0f), "InverseAffine");
+
+	constexpr ew::Camera CAMERA = ew::Camera();
+	constexpr ew::Mat4 VIEW_PROJECTION = CAMERA.ProjectionMatrix() * CAMERA.ViewMatrix();
+	static_assert(VIEW_PROJECTION[2][3] == -1.0f, "Perspective w = -z_view");
+	static_assert(nearlyEqual(akcGPR::Orthographic(2.0f, 1.0f, 0.0f, 1.0f)[0][0], 1.0f), "akcGPR::Orthographic");
+	static_assert(nearlyEqual(akcGPR::Perspective(ew::PI / 2, 1.0f, 0.1f, 10.0f)[1][1], 1.0f), "akcGPR::Perspective");
+}
+
+//Plain float[16] copy of the original hand-written scalar Mat4 multiply, used as the baseline
+struct RefMat4 {
+	float n[4][4];
+};
+
+static RefMat4 refMultiply(const RefMat4& l, const RefMat4& r) {
+	RefMat4 m;
+	for (int col = 0; col < 4; col++) {
+		for (int row = 0; row < 4; row++) {
+			m.n[col][row] = l.n[0][row] * r.n[col][0] + l.n[1][row] * r.n[col][1] + l.n[2][row] * r.n[col][2] + l.n[3][row] * r.n[col][3];
+		}
+	}
+	return m;
+}
+
+static ew::Vec4 refMultiply(const RefMat4& m, const ew::Vec4& v) {
+	return ew::Vec4(
+		m.n[0][0] * v.x + m.n[1][0] * v.y + m.n[2][0] * v.z + m.n[3][0] * v.w,
+		m.n[0][1] * v.x + m.n[1][1] * v.y + m.n[2][1] * v.z + m.n[3][1] * v.w,
+		m.n[0][2] * v.x + m.n[1][2] * v.y + m.n[2][2] * v.z + m.n[3][2] * v.w,
+		m.n[0][3] * v.x + m.n[1][3] * v.y + m.n[2][3] * v.z + m.n[3][3] * v.w
+	);
+}
+
+static RefMat4 toRef(const ew::Mat4& m) {
+	RefMat4 r;
+	memcpy(r.n, &m[0][0], sizeof(r.n));
+	return r;
+}
+
+//ew::Mat4 and glm::mat4 are both column major
+static glm::mat4 toGlm(const ew::Mat4& m) {
+	glm::mat4 r;
+	memcpy(&r[0].x, &m[0][0], sizeof(float) * 16);
+	return r;
+}
+
+static ew::Mat4 randomMatrix() {
+	return ew::Translate(ew::Vec3(ew::RandomRange(-10, 10), ew::RandomRange(-10, 10), ew::RandomRange(-10, 10)))
+		* ew::RotateY(ew::RandomRange(0, ew::TAU))
+		* ew::RotateX(ew::RandomRange(0, ew::TAU))
+		* ew::Scale(ew::Vec3(ew::RandomRange(0.1f, 2.0f)));
+}
+
+static ew::Vec3 randomVec3(float min, float max) {
+	return ew::Vec3(ew::RandomRange(min, max), ew::RandomRange(min, max), ew::RandomRange(min, max));
+}
+
+int main() {
+	//Inputs are indexed with (i & MASK) so every call sees different data
+	const int COUNT = 1024;
+	const int MASK = COUNT - 1;
+	std::vector<ew::Mat4> mats(COUNT), mats2(COUNT);
+	std::vector<RefMat4> refMats(COUNT), refMats2(COUNT);
+	std::vector<glm::mat4> glmMats(COUNT), glmMats2(COUNT);
+	std::vector<ew::Vec4> vec4s(COUNT);
+	std::vector<glm::vec4> glmVec4s(COUNT);
+	std::vector<ew::Vec3> vec3s(COUNT), vec3s2(COUNT);
+	std::vector<glm::vec3> glmVec3s(COUNT), glmVec3s2(COUNT);
+	std::vector<float> fovs(COUNT);
+	for (int i = 0; i < COUNT; i++) {
+		mats[i] = randomMatrix();
+		mats2[i] = randomMatrix();
+		refMats[i] = toRef(mats[i]);
+		refMats2[i] = toRef(mats2[i]);
+		glmMats[i] = toGlm(mats[i]);
+		glmMats2[i] = toGlm(mats2[i]);
+		vec4s[i] = ew::Vec4(randomVec3(-1, 1), 1.0f);
+		glmVec4s[i] = glm::vec4(vec4s[i].x, vec4s[i].y, vec4s[i].z, vec4s[i].w);
+		vec3s[i] = randomVec3(-10, 10);
+		vec3s2[i] = randomVec3(-10, 10);
+		glmVec3s[i] = glm::vec3(vec3s[i].x, vec3s[i].y, vec3s[i].z);
+		glmVec3s2[i] = glm::vec3(vec3s2[i].x, vec3s2[i].y, vec3s2[i].z);
+		fovs[i] = ew::RandomRange(0.5f, 1.5f);
+	}
+
+#if defined(EW_SIMD_AVX)
+	const char* path = "AVX";
+#elif defined(EW_SIMD_SSE)
+	const char* path = "SSE";
+#else
+	const char* path = "scalar";
+#endif
+	printf("ewMath code path: %s\n", path);
+
+	//Results must match the original scalar code exactly
+	int mismatches = 0;
+	for (int i = 0; i < COUNT; i++) {
+		ew::Mat4 m = mats[i] * mats2[i];
+		RefMat4 ref = refMultiply(refMats[i], refMats2[i]);
+		if (memcmp(&m[0][0], ref.n, sizeof(ref.n)) != 0)
+			mismatches++;
+		ew::Vec4 v = mats[i] * vec4s[i];
+		ew::Vec4 refV = refMultiply(refMats[i], vec4s[i]);
+		if (memcmp(&v, &refV, sizeof(ew::Vec4)) != 0)
+			mismatches++;
+	}
+	printf("Mismatches vs scalar reference: %d\n", mismatches);
+
+	bench::printHeader("Matrix multiply");
+	bench::print(bench::run("ew Mat4 * Mat4", [&](int i) { bench::doNotOptimize(mats[i & MASK] * mats2[(i + 1) & MASK]); }));
+	bench::print(bench::run("scalar reference Mat4 * Mat4", [&](int i) { bench::doNotOptimize(refMultiply(refMats[i & MASK], refMats2[(i + 1) & MASK])); }));
+	bench::print(bench::run("glm mat4 * mat4", [&](int i) { bench::doNotOptimize(glmMats[i & MASK] * glmMats2[(i + 1) & MASK]); }));
+	bench::print(bench::run("ew Mat4 * Vec4", [&](int i) { bench::doNotOptimize(mats[i & MASK] * vec4s[(i + 1) & MASK]); }));
+	bench::print(bench::run("scalar reference Mat4 * Vec4", [&](int i) { bench::doNotOptimize(refMultiply(refMats[i & MASK], vec4s[(i + 1) & MASK])); }));
+	bench::print(bench::run("glm mat4 * vec4", [&](int i) { bench::doNotOptimize(glmMats[i & MASK] * glmVec4s[(i + 1) & MASK]); }));
+
+	bench::printHeader("Vector ops");
+	bench::printComparison(
+		bench::run("ew Normalize", [&](int i) { bench::doNotOptimize(ew::Normalize(vec3s[i & MASK])); }),
+		bench::run("glm normalize", [&](int i) { bench::doNotOptimize(glm::normalize(glmVec3s[i & MASK])); }));
+	bench::printComparison(
+		bench::run("ew Cross", [&](int i) { bench::doNotOptimize(ew::Cross(vec3s[i & MASK], vec3s2[i & MASK])); }),
+		bench::run("glm cross", [&](int i) { bench::doNotOptimize(glm::cross(glmVec3s[i & MASK], glmVec3s2[i & MASK])); }));
+
+	bench::printHeader("Camera matrices");
+	bench::printComparison(
+		bench::run("ew LookAt", [&](int i) { bench::doNotOptimize(ew::LookAt(vec3s[i & MASK], vec3s2[i & MASK], ew::Vec3(0, 1, 0))); }),
+		bench::run("glm lookAt", [&](int i) { bench::doNotOptimize(glm::lookAt(glmVec3s[i & MASK], glmVec3s2[i & MASK], glm::vec3(0, 1, 0))); }));
+	bench::printComparison(
+		bench::run("ew Perspective", [&](int i) { bench::doNotOptimize(ew::Perspective(fovs[i & MASK], 1.77f, 0.1f, 100.0f)); }),
+		bench::run("glm perspective", [&](int i) { bench::doNotOptimize(glm::perspective(fovs[i & MASK], 1.77f, 0.1f, 100.0f)); }));
+
+	bench::printHeader("Inverse");
+	bench::printComparison(
+		bench::run("ew Inverse", [&](int i) { bench::doNotOptimize(ew::Inverse(mats[i & MASK])); }),
+		bench::run("glm inverse", [&](int i) { bench::doNotOptimize(glm::inverse(glmMats[i & MASK])); }));
+	bench::print(bench::run("ew InverseAffine", [&](int i) { bench::doNotOptimize(ew::InverseAffine(mats[i & MASK])); }));
+	bench::print(bench::run("ew NormalMatrix", [&](int i) { bench::doNotOptimize(ew::NormalMatrix(mats[i & MASK])); }));
+
+	//Batched SoA point transform vs one Mat4 * Vec4 per point. One op = one point
+	const int NUM_POINTS = 1 << 14;
+	std::vector<float> xs(NUM_POINTS), ys(NUM_POINTS), zs(NUM_POINTS);
+	std::vector<ew::Vec4> points(NUM_POINTS);
+	for (int i = 0; i < NUM_POINTS; i++) {
+		xs[i] = ew::RandomRange(-1, 1);
+		ys[i] = ew::RandomRange(-1, 1);
+		zs[i] = ew::RandomRange(-1, 1);
+		points[i] = ew::Vec4(xs[i], ys[i], zs[i], 1.0f);
+	}
+	std::vector<float> outXs(NUM_POINTS), outYs(NUM_POINTS), outZs(NUM_POINTS);
+	std::vector<ew::Vec4> outPoints(NUM_POINTS);
+	const ew::Mat4 model = randomMatrix();
+	bench::Settings pointSettings;
+	pointSettings.batchSize = 1;
+	pointSettings.repetitions = 100;
+	bench::printHeader("Point transform (ns per point)");
+	bench::Result perPoint = bench::run("Mat4 * Vec4 per point", [&](int) {
+		for (int i = 0; i < NUM_POINTS; i++)
+			outPoints[i] = model * points[i];
+		bench::doNotOptimize(outPoints[0]);
+	}, pointSettings);
+	bench::Result batched = bench::run("TransformPoints", [&](int) {
+		ew::TransformPoints(model, xs.data(), ys.data(), zs.data(), outXs.data(), outYs.data(), outZs.data(), NUM_POINTS);
+		bench::doNotOptimize(outXs[0]);
+	}, pointSettings);
+	for (bench::Result* r : { &perPoint, &batched }) {
+		r->medianNs /= NUM_POINTS;
+		r->p99Ns /= NUM_POINTS;
+		r->minNs /= NUM_POINTS;
+	}
+	bench::printComparison(batched, perPoint);
+
+	//Model matrix per object: five matrix product vs closed form TRS vs cached Transform
+	std::vector<ew::Transform> transforms(COUNT);
+	std::vector<ew::Vec3> eulerRotations(COUNT);
+	for (int i = 0; i < COUNT; i++) {
+		eulerRotations[i] = randomVec3(0, 360);
+		transforms[i].setPosition(randomVec3(-10, 10));
+		transforms[i].setEulerRotation(eulerRotations[i]);
+		transforms[i].setScale(ew::Vec3(ew::RandomRange(0.1f, 2.0f)));
+	}
+	bench::printHeader("Model matrix");
+	bench::print(bench::run("5 matrix product", [&](int i) {
+		const ew::Transform& t = transforms[i & MASK];
+		const ew::Vec3& r = eulerRotations[i & MASK];
+		bench::doNotOptimize(ew::Translate(t.getPosition())
+			* ew::RotateY(ew::Radians(r.y))
+			* ew::RotateX(ew::Radians(r.x))
+			* ew::RotateZ(ew::Radians(r.z))
+			* ew::Scale(t.getScale()));
+	}));
+	bench::print(bench::run("Euler TRS", [&](int i) {
+		const ew::Transform& t = transforms[i & MASK];
+		bench::doNotOptimize(ew::TRS(t.getPosition(), eulerRotations[i & MASK] * ew::DEG2RAD, t.getScale()));
+	}));
+	bench::print(bench::run("Quat TRS", [&](int i) {
+		const ew::Transform& t = transforms[i & MASK];
+		bench::doNotOptimize(ew::TRS(t.getPosition(), t.getRotation(), t.getScale()));
+	}));
+	bench::print(bench::run("cached Transform", [&](int i) { bench::doNotOptimize(transforms[i & MASK].getModelMatrix()); }));
+
+	//Animated orientations: interpolate between two keys, then compose with a parent rotation
+	std::vector<ew::Quat> keysA(COUNT), keysB(COUNT);
+	std::vector<glm::quat> glmKeysA(COUNT), glmKeysB(COUNT);
+	for (int i = 0; i < COUNT; i++) {
+		keysA[i] = ew::FromEuler(eulerRotations[i] * ew::DEG2RAD);
+		keysB[i] = ew::FromEuler(eulerRotations[(i + 1) & MASK] * ew::DEG2RAD);
+		glmKeysA[i] = glm::quat(keysA[i].w, keysA[i].x, keysA[i].y, keysA[i].z);
+		glmKeysB[i] = glm::quat(keysB[i].w, keysB[i].x, keysB[i].y, keysB[i].z);
+	}
+	const ew::Quat parent = ew::AngleAxis(0.5f, ew::Vec3(0, 1, 0));
+	const glm::quat glmParent = glm::angleAxis(0.5f, glm::vec3(0, 1, 0));
+	bench::printHeader("Quaternions");
+	bench::printComparison(
+		bench::run("ew Slerp + compose", [&](int i) { bench::doNotOptimize(parent * ew::Slerp(keysA[i & MASK], keysB[i & MASK], fovs[i & MASK] - 0.5f)); }),
+		bench::run("glm slerp + compose", [&](int i) { bench::doNotOptimize(glmParent * glm::slerp(glmKeysA[i & MASK], glmKeysB[i & MASK], fovs[i & MASK] - 0.5f)); }));
+	bench::print(bench::run("ew Nlerp + compose", [&](int i) { bench::doNotOptimize(parent * ew::Nlerp(keysA[i & MASK], keysB[i & MASK], fovs[i & MASK] - 0.5f)); }));
+	bench::printComparison(
+		bench::run("ew ToMat4", [&](int i) { bench::doNotOptimize(ew::ToMat4(keysA[i & MASK])); }),
+		bench::run("glm mat4_cast", [&](int i) { bench::doNotOptimize(glm::mat4_cast(glmKeysA[i & MASK])); }));
+
+	//Frustum culling: spheres scattered around the default camera, per object vs batched
+	ew::Camera cullCamera;
+	const ew::Frustum frustum = ew::ExtractFrustum(cullCamera.ProjectionMatrix() * cullCamera.ViewMatrix());
+	std::vector<float> cxs(NUM_POINTS), cys(NUM_POINTS), czs(NUM_POINTS), radii(NUM_POINTS);
+	std::vector<unsigned char> visible(NUM_POINTS);
+	for (int i = 0; i < NUM_POINTS; i++) {
+		cxs[i] = ew::RandomRange(-50, 50);
+		cys[i] = ew::RandomRange(-50, 50);
+		czs[i] = ew::RandomRange(-50, 50);
+		radii[i] = ew::RandomRange(0.1f, 2.0f);
+	}
+	size_t numVisible = 0;
+	bench::printHeader("Frustum culling (ns per object)");
+	bench::Result perSphere = bench::run("IsSphereVisible per object", [&](int) {
+		numVisible = 0;
+		for (int i = 0; i < NUM_POINTS; i++) {
+			visible[i] = ew::IsSphereVisible(frustum, ew::Vec3(cxs[i], cys[i], czs[i]), radii[i]);
+			numVisible += visible[i];
+		}
+		bench::doNotOptimize(numVisible);
+	}, pointSettings);
+	bench::Result batchedSpheres = bench::run("CullSpheres", [&](int) {
+		numVisible = ew::CullSpheres(frustum, cxs.data(), cys.data(), czs.data(), radii.data(), NUM_POINTS, visible.data());
+		bench::doNotOptimize(numVisible);
+	}, pointSettings);
+	bench::Result batchedBoxes = bench::run("CullAABBs", [&](int) {
+		numVisible = ew::CullAABBs(frustum, cxs.data(), cys.data(), czs.data(), radii.data(), radii.data(), radii.data(), NUM_POINTS, visible.data());
+		bench::doNotOptimize(numVisible);
+	}, pointSettings);
+	for (bench::Result* r : { &perSphere, &batchedSpheres, &batchedBoxes }) {
+		r->medianNs /= NUM_POINTS;
+		r->p99Ns /= NUM_POINTS;
+		r->minNs /= NUM_POINTS;
+	}
+	bench::printComparison(batchedSpheres, perSphere);
+	bench::print(batchedBoxes);
+	printf("%zu of %d spheres visible\n", ew::CullSpheres(frustum, cxs.data(), cys.data(), czs.data(), radii.data(), NUM_POINTS, visible.data()), NUM_POINTS);
+
+	return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ew/mesh.h>
+#include <ew/procGen.h>
+#include <ew/meshLoader.h>
+
+#ifdef EW_BENCH_ASSIMP
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#endif
+
+#include "benchHarness.h"
+
+//Generated inputs are written next to the executable
+const char* OBJ_PATH = "meshload_bench.obj";
+const char* GLB_PATH = "meshload_bench.glb";
+const int REPETITIONS = 5;
+
+static size_t fileSize(const char* filePath) {
+	FILE* file = fopen(filePath, "rb");
+	if (file == NULL)
+		return 0;
+	fseek(file, 0, SEEK_END);
+	const long size = ftell(file);
+	fclose(file);
+	return size > 0 ? (size_t)size : 0;
+}
+
+//The inputs are about 65 MB, so they are not left behind
+static void removeInputs() {
+	remove(OBJ_PATH);
+	remove(GLB_PATH);
+}
+
+//Faces reference separate position, uv and normal lists, like exporter output
+static bool writeOBJ(const char* filePath, const ew::MeshData& meshData) {
+	FILE* file = fopen(filePath, "w");
+	if (file == NULL)
+		return false;
+	for (const ew::Vertex& v : meshData.vertices)
+		fprintf(file, "v %.6f %.6f %.6f\n", v.pos.x, v.pos.y, v.pos.z);
+	for (const ew::Vertex& v : meshData.vertices)
+		fprintf(file, "vt %.6f %.6f\n", v.uv.x, v.uv.y);
+	for (const ew::Vertex& v : meshData.vertices)
+		fprintf(file, "vn %.6f %.6f %.6f\n", v.normal.x, v.normal.y, v.normal.z);
+	for (size_t i = 0; i + 2 < meshData.indices.size(); i += 3) {
+		const unsigned int a = meshData.indices[i] + 1, b = meshData.indices[i + 1] + 1, c = meshData.indices[i + 2] + 1;
+		fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c, c, c);
+	}
+	return fclose(file) == 0;
+}
+
+//One mesh with interleaved POSITION/NORMAL/TEXCOORD_0 and 32 bit indices, instanced by two translated nodes
+static bool writeGLB(const char* filePath, const ew::MeshData& meshData) {
+	const size_t vertexBytes = meshData.vertices.size() * sizeof(ew::Vertex);
+	const size_t indexBytes = meshData.indices.size() * sizeof(unsigned int);
+	const ew::Bounds& b = meshData.bounds;
+	char json[2048];
+	snprintf(json, sizeof(json),
+		"{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0,1]}],"
+		"\"nodes\":[{\"mesh\":0,\"translation\":[-2,0,0]},{\"mesh\":0,\"translation\":[2,0,0],\"scale\":[0.5,0.5,0.5]}],"
+		"\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},\"indices\":3,\"mode\":4}]}],"
+		"\"buffers\":[{\"byteLength\":%zu}],"
+		"\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":%zu,\"byteStride\":%zu},{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu}],"
+		"\"accessors\":["
+		"{\"bufferView\":0,\"byteOffset\":0,\"componentType\":5126,\"count\":%zu,\"type\":\"VEC3\",\"min\":[%g,%g,%g],\"max\":[%g,%g,%g]},"
+		"{\"bufferView\":0,\"byteOffset\":12,\"componentType\":5126,\"count\":%zu,\"type\":\"VEC3\"},"
+		"{\"bufferView\":0,\"byteOffset\":24,\"componentType\":5126,\"count\":%zu,\"type\":\"VEC2\"},"
+		"{\"bufferView\":1,\"componentType\":5125,\"count\":%zu,\"type\":\"SCALAR\"}]}",
+		vertexBytes + indexBytes, vertexBytes, sizeof(ew::Vertex), vertexBytes, indexBytes,
+		meshData.vertices.size(), b.min.x, b.min.y, b.min.z, b.max.x, b.max.y, b.max.z,
+		meshData.vertices.size(), meshData.vertices.size(), meshData.indices.size());
+	//glTF flips v relative to OpenGL
+	std::vector<ew::Vertex> vertices = meshData.vertices;
+	for (ew::Vertex& v : vertices)
+		v.uv.y = 1.0f - v.uv.y;
+
+	std::string jsonChunk(json);
+	while (jsonChunk.size() % 4 != 0)
+		jsonChunk += ' ';
+	const uint32_t binLength = (uint32_t)(vertexBytes + indexBytes);
+	const uint32_t totalLength = 12 + 8 + (uint32_t)jsonChunk.size() + 8 + binLength;
+	const uint32_t header[5] = { 0x46546c67, 2, totalLength, (uint32_t)jsonChunk.size(), 0x4e4f534a };
+	const uint32_t binHeader[2] = { binLength, 0x004e4942 };
+	FILE* file = fopen(filePath, "wb");
+	if (file == NULL)
+		return false;
+	fwrite(header, sizeof(header), 1, file);
+	fwrite(jsonChunk.data(), 1, jsonChunk.size(), file);
+	fwrite(binHeader, sizeof(binHeader), 1, file);
+	fwrite(vertices.data(), 1, vertexBytes, file);
+	fwrite(meshData.indices.data(), 1, indexBytes, file);
+	return fclose(file) == 0;
+}
+
+//Best of REPETITIONS, reported as MB/s of file read. load returns the number of triangles
+template<typename Fn>
+static void measure(const char* name, const char* filePath, Fn load) {
+	double best = 1e30;
+	size_t triangles = 0;
+	for (int r = 0; r < REPETITIONS; r++) {
+		auto start = std::chrono::steady_clock::now();
+		triangles = load(filePath);
+		auto end = std::chrono::steady_clock::now();
+		best = std::min(best, std::chrono::duration<double>(end - start).count());
+	}
+	const double megabytes = fileSize(filePath) / (1024.0 * 1024.0);
+	printf("%-36s %10.2f %10.1f %12zu\n", name, best * 1000.0, megabytes / best, triangles);
+}
+
+//Where a copy of the source mesh is expected in the loaded one: positions scaled, then offset
+struct Instance {
+	float scale;
+	ew::Vec3 offset;
+};
+
+static bool nearlyEqual(const ew::Vec3& a, const ew::Vec3& b, float tolerance) {
+	return fabsf(a.x - b.x) <= tolerance && fabsf(a.y - b.y) <= tolerance && fabsf(a.z - b.z) <= tolerance;
+}
+
+//Checks every loaded triangle corner against the same corner of the mesh the file was written from.
+//Copies are expected one after another, in the order of instances. Returns false on mismatch
+static bool validate(const char* name, const ew::MeshData& loaded, const ew::MeshData& expected, const std::vector<Instance>& instances) {
+	const size_t numIndices = expected.indices.size();
+	if (loaded.indices.size() != numIndices * instances.size()) {
+		printf("%s: loaded %zu indices, expected %zu\n", name, loaded.indices.size(), numIndices * instances.size());
+		return false;
+	}
+	//The OBJ is written with 6 decimals
+	const float TOLERANCE = 1e-4f;
+	size_t mismatches = 0;
+	for (size_t c = 0; c < instances.size(); c++) {
+		for (size_t i = 0; i < numIndices; i++) {
+			const unsigned int index = loaded.indices[c * numIndices + i];
+			if (index >= loaded.vertices.size()) {
+				if (mismatches++ == 0)
+					printf("%s: index %zu out of range (%u of %zu vertices)\n", name, c * numIndices + i, index, loaded.vertices.size());
+				continue;
+			}
+			const ew::Vertex& v = loaded.vertices[index];
+			const ew::Vertex& e = expected.vertices[expected.indices[i]];
+			const ew::Vec3 position = e.pos * instances[c].scale + instances[c].offset;
+			const bool same = nearlyEqual(v.pos, position, TOLERANCE) && nearlyEqual(v.normal, e.normal, TOLERANCE) &&
+				fabsf(v.uv.x - e.uv.x) <= TOLERANCE && fabsf(v.uv.y - e.uv.y) <= TOLERANCE;
+			if (!same && mismatches++ == 0) {
+				printf("%s: corner %zu is pos (%g %g %g) normal (%g %g %g) uv (%g %g), expected pos (%g %g %g) normal (%g %g %g) uv (%g %g)\n",
+					name, c * numIndices + i, v.pos.x, v.pos.y, v.pos.z, v.normal.x, v.normal.y, v.normal.z, v.uv.x, v.uv.y,
+					position.x, position.y, position.z, e.normal.x, e.normal.y, e.normal.z, e.uv.x, e.uv.y);
+			}
+		}
+	}
+	if (mismatches > 0)
+		printf("%s: %zu of %zu corners differ from the source mesh\n", name, mismatches, loaded.indices.size());
+	return mismatches == 0;
+}
+
+int main() {
+	const unsigned int numThreads = std::max(1u, std::thread::hardware_concurrency());
+	//512 segment UV sphere: ~263k vertices, ~523k triangles
+	ew::MeshData sphere = ew::createSphere(1.0f, 512);
+	if (!writeOBJ(OBJ_PATH, sphere) || !writeGLB(GLB_PATH, sphere)) {
+		printf("Failed to write benchmark inputs\n");
+		removeInputs();
+		return 1;
+	}
+	printf("%s: %.1f MB, %s: %.1f MB, %u hardware threads\n", OBJ_PATH, fileSize(OBJ_PATH) / (1024.0 * 1024.0),
+		GLB_PATH, fileSize(GLB_PATH) / (1024.0 * 1024.0), numThreads);
+
+	//The GLB has the two node transforms from writeGLB applied
+	bool ok = validate("loadOBJ", ew::loadOBJ(OBJ_PATH), sphere, { { 1.0f, ew::Vec3(0) } });
+	ok = validate("loadGLB", ew::loadGLB(GLB_PATH), sphere, { { 1.0f, ew::Vec3(-2, 0, 0) }, { 0.5f, ew::Vec3(2, 0, 0) } }) && ok;
+	if (!ok) {
+		removeInputs();
+		return 1;
+	}
+
+	printf("\n%-36s %10s %10s %12s\n", "loader", "best ms", "MB/s", "triangles");
+	measure("ew::loadOBJ (1 thread)", OBJ_PATH, [](const char* path) { return ew::loadOBJ(path, 1).indices.size() / 3; });
+	char name[64];
+	snprintf(name, sizeof(name), "ew::loadOBJ (%u threads)", numThreads);
+	measure(name, OBJ_PATH, [=](const char* path) { return ew::loadOBJ(path, numThreads).indices.size() / 3; });
+	measure("ew::loadGLB", GLB_PATH, [](const char* path) { return ew::loadGLB(path).indices.size() / 3; });
+
+#ifdef EW_BENCH_ASSIMP
+	//Same output as the ew loaders: triangulated, one vertex per unique position/uv/normal
+	auto assimpLoad = [](const char* path) {
+		Assimp::Importer importer;
+		const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_GenSmoothNormals | aiProcess_PreTransformVertices);
+		size_t triangles = 0;
+		for (unsigned int i = 0; scene && i < scene->mNumMeshes; i++)
+			triangles += scene->mMeshes[i]->mNumFaces;
+		return triangles;
+	};
+	measure("assimp OBJ", OBJ_PATH, assimpLoad);
+	measure("assimp GLB", GLB_PATH, assimpLoad);
+#else
+	printf("(configure with -DEW_BENCH_ASSIMP=ON to compare against assimp)\n");
+#endif
+	removeInputs();
+	return 0;
+}
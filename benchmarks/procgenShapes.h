@@ -0,0 +1,77 @@
+#pragma once
+#include <stdio.h>
+#include <functional>
+#include <vector>
+
+#include <ew/mesh.h>
+#include <ew/procGen.h>
+#include <akcGPR/procGen.h>
+
+//Every generator from both families, and the topology checks run on their output.
+//Shared by procgen_bench and the procgen_topology test
+namespace procgen {
+	struct TopologyReport {
+		size_t badIndices = 0; //Out of range, or a trailing partial triangle
+		size_t degenerate = 0; //Repeated index or zero area
+		size_t flipped = 0; //Face normal disagrees with the vertex normals, or points into a closed shape
+		inline bool ok()const { return badIndices == 0 && degenerate == 0 && flipped == 0; }
+	};
+
+	//Closed shapes are all convex and centered on the origin, so their faces must also point away from it
+	inline TopologyReport checkTopology(const ew::MeshData& meshData, bool closed) {
+		TopologyReport report;
+		const size_t numVertices = meshData.vertices.size();
+		report.badIndices = meshData.indices.size() % 3;
+		for (size_t i = 0; i + 2 < meshData.indices.size(); i += 3) {
+			const unsigned int a = meshData.indices[i], b = meshData.indices[i + 1], c = meshData.indices[i + 2];
+			if (a >= numVertices || b >= numVertices || c >= numVertices) {
+				report.badIndices++;
+				continue;
+			}
+			const ew::Vertex& va = meshData.vertices[a];
+			const ew::Vertex& vb = meshData.vertices[b];
+			const ew::Vertex& vc = meshData.vertices[c];
+			const ew::Vec3 e1 = vb.pos - va.pos, e2 = vc.pos - va.pos;
+			const ew::Vec3 n = ew::Cross(e1, e2);
+			//Relative to the edge lengths, so tiny but well shaped triangles still pass
+			if (a == b || b == c || a == c || ew::Magnitude(n) <= 1e-6f * ew::Magnitude(e1) * ew::Magnitude(e2)) {
+				report.degenerate++;
+				continue;
+			}
+			const ew::Vec3 centroid = (va.pos + vb.pos + vc.pos) * (1.0f / 3.0f);
+			if (ew::Dot(n, va.normal + vb.normal + vc.normal) <= 0 || (closed && ew::Dot(n, centroid) <= 0))
+				report.flipped++;
+		}
+		return report;
+	}
+
+	struct Shape {
+		const char* name;
+		bool closed;
+		int minParameter; //Smallest subdivisions or level that encloses a volume
+		int maxCheckedParameter; //procgen_topology checks every parameter up to here. Equal to minParameter for shapes without one
+		bool isLevel; //Parameter is a recursive subdivision level (4x the triangles per step) instead of segments
+		std::function<ew::MeshData(int)> generate;
+	};
+
+	inline std::vector<Shape> allShapes() {
+		return {
+			{ "ew::cube", true, 0, 0, false, [](int) { return ew::createCube(1.0f); } },
+			{ "ew::plane", false, 1, 8, false, [](int s) { return ew::createPlane(1.0f, 1.0f, s); } },
+			{ "ew::sphere", true, 3, 8, false, [](int s) { return ew::createSphere(1.0f, s); } },
+			{ "ew::cylinder", true, 3, 8, false, [](int s) { return ew::createCylinder(1.0f, 1.0f, s); } },
+			{ "ew::icosphere", true, 0, 5, true, [](int level) { return ew::createIcosphere(1.0f, level); } },
+			{ "akcGPR::plane", false, 1, 8, false, [](int s) { return akcGPR::createPlane(1.0f, 1.0f, s); } },
+			{ "akcGPR::sphere", true, 3, 8, false, [](int s) { return akcGPR::createSphere(1.0f, s); } },
+			{ "akcGPR::cylinder", true, 3, 8, false, [](int s) { return akcGPR::createCylinder(1.0f, 1.0f, s); } },
+		};
+	}
+
+	inline bool reportFailure(const Shape& shape, int parameter, const TopologyReport& report) {
+		if (report.ok())
+			return false;
+		printf("FAIL %s(%d): %zu bad indices, %zu degenerate, %zu flipped\n", shape.name, parameter,
+			report.badIndices, report.degenerate, report.flipped);
+		return true;
+	}
+}
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include <ew/mesh.h>
+#include <ew/threadPool.h>
+#include <ew/procGen.h>
+#include <akcGPR/procGen.h>
+
+#include "benchHarness.h"
+#include "procgenShapes.h"
+
+//Every heap allocation in the process is counted, so a generator's allocations can be read off as a difference
+static std::atomic<size_t> allocatedBytes(0);
+static std::atomic<size_t> numAllocations(0);
+
+#if defined(__GNUC__) && !defined(__clang__)
+//GCC sees the free() below inlined next to a call to operator new and warns about a mismatch
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(size_t size) {
+	allocatedBytes += size;
+	numAllocations++;
+	if (void* p = malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {
+	free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+	free(p);
+}
+
+//Best time of a few runs. Large meshes get fewer runs so the whole sweep stays under a minute or so
+static double bestMs(size_t numVertices, const std::function<size_t()>& generate) {
+	const int repetitions = (int)std::max<size_t>(1, std::min<size_t>(20, (1 << 22) / std::max<size_t>(numVertices, 1)));
+	double best = 1e30;
+	for (int r = 0; r < repetitions; r++) {
+		auto start = std::chrono::steady_clock::now();
+		bench::doNotOptimize(generate());
+		auto end = std::chrono::steady_clock::now();
+		best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+	}
+	return best;
+}
+
+//Largest distance between a flat triangle and the sphere it approximates, i.e. the silhouette error
+static float maxSphereError(const ew::MeshData& meshData, float radius) {
+	float maxError = 0;
+	for (size_t i = 0; i + 2 < meshData.indices.size(); i += 3) {
+		const ew::Vec3& a = meshData.vertices[meshData.indices[i]].pos;
+		const ew::Vec3 n = ew::Cross(meshData.vertices[meshData.indices[i + 1]].pos - a, meshData.vertices[meshData.indices[i + 2]].pos - a);
+		const float length = ew::Magnitude(n);
+		if (length > 0)
+			maxError = std::max(maxError, radius - fabsf(ew::Dot(n, a)) / length);
+	}
+	return maxError;
+}
+
+//Icosphere against the UV sphere (ew::createSphere) with the same silhouette error
+static void compareIcosphere(int maxLevel) {
+	printf("\nIcosphere vs UV sphere at equal silhouette error (radius 1)\n");
+	printf("%-6s %10s %10s %10s %10s %12s %10s %10s %10s\n", "level", "verts", "tris", "error", "best ms", "UV subdiv", "UV verts", "UV tris", "UV ms");
+	for (int level = 1; level <= maxLevel; level++) {
+		ew::MeshData icosphere = ew::createIcosphere(1.0f, level);
+		const float error = maxSphereError(icosphere, 1.0f);
+		//Error shrinks as subdivisions grow, so search for the fewest subdivisions that match
+		int low = 3, high = 4096;
+		while (low < high) {
+			const int mid = (low + high) / 2;
+			if (maxSphereError(ew::createSphere(1.0f, mid), 1.0f) <= error)
+				high = mid;
+			else
+				low = mid + 1;
+		}
+		const ew::MeshData uvSphere = ew::createSphere(1.0f, low);
+		const double icoMs = bestMs(icosphere.vertices.size(), [&]() { return ew::createIcosphere(1.0f, level).indices.size(); });
+		const double uvMs = bestMs(uvSphere.vertices.size(), [&]() { return ew::createSphere(1.0f, low).indices.size(); });
+		printf("%-6d %10zu %10zu %10.6f %10.3f %12d %10zu %10zu %10.3f\n", level, icosphere.vertices.size(), icosphere.indices.size() / 3,
+			error, icoMs, low, uvSphere.vertices.size(), uvSphere.indices.size() / 3, uvMs);
+	}
+}
+
+//Times each shape at the sweep sizes and checks the result. Returns the number of failed meshes.
+//The small sizes are checked by the procgen_topology test
+static int benchmarkShapes(const std::vector<procgen::Shape>& shapes, int maxSubdivisions) {
+	int failures = 0;
+	printf("Generators, single thread for ew::, shared pool for akcGPR::\n");
+	printf("%-18s %6s %10s %10s %10s %10s %10s %8s %10s %6s\n", "shape", "param", "verts", "tris", "best ms",
+		"Mverts/s", "alloc MB", "allocs", "mesh MB", "check");
+	for (const procgen::Shape& shape : shapes) {
+		//Levels 2, 4, 6 ... track the triangle counts of 16, 64, 256 ... segments
+		std::vector<int> parameters;
+		for (int subdivisions = 16, level = 2; subdivisions <= maxSubdivisions; subdivisions *= 4, level += 2)
+			parameters.push_back(shape.isLevel ? level : subdivisions);
+		if (shape.minParameter == shape.maxCheckedParameter)
+			parameters = { shape.minParameter };
+		for (int p : parameters) {
+			const size_t bytesBefore = allocatedBytes, allocationsBefore = numAllocations;
+			ew::MeshData meshData = shape.generate(p);
+			const size_t bytes = allocatedBytes - bytesBefore, allocations = numAllocations - allocationsBefore;
+			const size_t meshBytes = meshData.vertices.capacity() * sizeof(ew::Vertex) + meshData.indices.capacity() * sizeof(unsigned int);
+			const procgen::TopologyReport report = procgen::checkTopology(meshData, shape.closed);
+			const size_t numVertices = meshData.vertices.size(), numTriangles = meshData.indices.size() / 3;
+			meshData = ew::MeshData();
+			const double ms = bestMs(numVertices, [&]() { return shape.generate(p).indices.size(); });
+			printf("%-18s %6d %10zu %10zu %10.3f %10.1f %10.2f %8zu %10.2f %6s\n", shape.name, p, numVertices, numTriangles, ms,
+				numVertices / ms / 1000.0, bytes / (1024.0 * 1024.0), allocations, meshBytes / (1024.0 * 1024.0), report.ok() ? "ok" : "FAIL");
+			failures += procgen::reportFailure(shape, p, report);
+		}
+	}
+	return failures;
+}
+
+//Usage: procgen_bench [max subdivisions]. Default 4096, which needs about 1 GB for the sphere.
+//Exits with 1 if any generated mesh fails the topology checks
+int main(int argc, char** argv) {
+	const int maxSubdivisions = argc > 1 ? atoi(argv[1]) : 4096;
+	const unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+	const int failures = benchmarkShapes(procgen::allShapes(), maxSubdivisions);
+
+	//1, 2, 4 ... threads, and always the full machine
+	std::vector<std::unique_ptr<ew::ThreadPool>> pools;
+	for (unsigned int n = 1; n < hardwareThreads; n *= 2)
+		pools.emplace_back(new ew::ThreadPool(n));
+	pools.emplace_back(new ew::ThreadPool(hardwareThreads));
+
+	printf("\nakcGPR generator scaling, %u hardware threads\n", hardwareThreads);
+	printf("%-8s %8s %8s %12s %12s %10s\n", "shape", "subdiv", "threads", "best ms", "Mverts/s", "speedup");
+	for (int subdivisions = 16; subdivisions <= maxSubdivisions; subdivisions *= 4) {
+		const size_t numVertices = (size_t)(subdivisions + 1) * (subdivisions + 1);
+		for (int shape = 0; shape < 2; shape++) {
+			double singleThreadMs = 0;
+			for (const auto& pool : pools) {
+				ew::ThreadPool* p = pool.get();
+				const double ms = bestMs(numVertices, [&]() {
+					ew::MeshData meshData = shape == 0 ? akcGPR::createSphere(1.0f, subdivisions, p) : akcGPR::createPlane(1.0f, 1.0f, subdivisions, p);
+					return meshData.indices.size();
+				});
+				if (p->getNumThreads() == 1)
+					singleThreadMs = ms;
+				printf("%-8s %8d %8u %12.3f %12.1f %9.2fx\n", shape == 0 ? "sphere" : "plane", subdivisions, p->getNumThreads(),
+					ms, numVertices / ms / 1000.0, singleThreadMs / ms);
+			}
+		}
+	}
+	compareIcosphere(maxSubdivisions >= 4096 ? 8 : 6);
+	if (failures > 0)
+		printf("\n%d meshes failed the topology checks\n", failures);
+	return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,55 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <ew/mesh.h>
+#include <ew/threadPool.h>
+#include <akcGPR/procGen.h>
+
+#include "procgenShapes.h"
+
+//Same vertices and indices, bit for bit
+static bool identical(const ew::MeshData& a, const ew::MeshData& b) {
+	return a.vertices.size() == b.vertices.size() && a.indices == b.indices &&
+		memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(ew::Vertex)) == 0;
+}
+
+//Exits with 1 if any mesh fails
+int main() {
+	int failures = 0;
+	int numMeshes = 0;
+
+	//Every small size, where off by one mistakes show up, then a couple of larger ones
+	for (const procgen::Shape& shape : procgen::allShapes()) {
+		std::vector<int> parameters;
+		for (int p = shape.minParameter; p <= shape.maxCheckedParameter; p++)
+			parameters.push_back(p);
+		if (shape.minParameter != shape.maxCheckedParameter) {
+			if (shape.isLevel)
+				parameters.push_back(6);
+			else
+				parameters.insert(parameters.end(), { 16, 64, 255 });
+		}
+		for (int p : parameters) {
+			failures += procgen::reportFailure(shape, p, procgen::checkTopology(shape.generate(p), shape.closed));
+			numMeshes++;
+		}
+	}
+
+	//The threaded akcGPR generators must not depend on how rows are split between threads
+	ew::ThreadPool serial(1), parallel(4);
+	for (int subdivisions : { 3, 17, 200, 1000 }) {
+		if (!identical(akcGPR::createSphere(1.0f, subdivisions, &serial), akcGPR::createSphere(1.0f, subdivisions, &parallel))) {
+			printf("FAIL akcGPR::sphere(%d) differs between 1 and 4 threads\n", subdivisions);
+			failures++;
+		}
+		if (!identical(akcGPR::createPlane(1.0f, 1.0f, subdivisions, &serial), akcGPR::createPlane(1.0f, 1.0f, subdivisions, &parallel))) {
+			printf("FAIL akcGPR::plane(%d) differs between 1 and 4 threads\n", subdivisions);
+			failures++;
+		}
+		numMeshes += 2;
+	}
+
+	printf("%d of %d meshes failed\n", failures, numMeshes);
+	return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,85 @@
+#include <stdio.h>
+
+#include <ew/external/glad.h>
+#include <ew/terrain.h>
+
+//Just enough of OpenGL for Mesh::load to run without a context
+static GLuint nextName = 1;
+static void genNames(GLsizei n, GLuint* names) {
+	for (GLsizei i = 0; i < n; i++)
+		names[i] = nextName++;
+}
+static void deleteNames(GLsizei, const GLuint*) {}
+static void bindVertexArray(GLuint) {}
+static void bindBuffer(GLenum, GLuint) {}
+static void bufferData(GLenum, GLsizeiptr, const void*, GLenum) {}
+static void enableAttribute(GLuint) {}
+static void attributePointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) {}
+static void attributeDivisor(GLuint, GLuint) {}
+
+static void stubOpenGL() {
+	glad_glGenVertexArrays = genNames;
+	glad_glGenBuffers = genNames;
+	glad_glDeleteVertexArrays = deleteNames;
+	glad_glDeleteBuffers = deleteNames;
+	glad_glBindVertexArray = bindVertexArray;
+	glad_glBindBuffer = bindBuffer;
+	glad_glBufferData = bufferData;
+	glad_glEnableVertexAttribArray = enableAttribute;
+	glad_glVertexAttribPointer = attributePointer;
+	glad_glVertexAttribDivisor = attributeDivisor;
+}
+
+//Updates until nothing is generating or waiting for upload. Returns the number of frames, or -1 if it never settles
+static int settle(ew::Terrain& terrain, const ew::Camera& camera, int maxFrames) {
+	for (int frame = 1; frame <= maxFrames; frame++) {
+		terrain.update(camera);
+		if (terrain.getNumPendingChunks() == 0)
+			return frame;
+	}
+	return -1;
+}
+
+//Exits with 1 if streaming does not settle with every chunk in view distance loaded
+int main() {
+	stubOpenGL();
+	//Same settings as assignment 7
+	ew::TerrainSettings settings;
+	settings.chunkSize = 8.0f;
+	settings.chunkResolution = 32;
+	settings.lodDistance = 12.0f;
+	settings.viewDistance = 96.0f;
+	//Uploads slower than generation, so finished chunks wait in the upload queue. Chunks must not be requested
+	//again while they wait, or the queue fills with duplicates and loading never catches up
+	settings.maxUploadsPerFrame = 1;
+	ew::Terrain terrain(settings, [](float x, float z) {
+		return ew::TerrainNoise(x / 32.0f, z / 32.0f, 1, 5) * 3.0f - 4.0f;
+	});
+
+	//Chunks whose nearest point is within the view distance of a camera on a chunk corner
+	int expected = 0;
+	const int range = (int)(settings.viewDistance / settings.chunkSize) + 1;
+	for (int z = -range; z <= range; z++) {
+		for (int x = -range; x <= range; x++) {
+			const float dx = (x > 0 ? x : x < 0 ? x + 1 : 0) * settings.chunkSize;
+			const float dz = (z > 0 ? z : z < 0 ? z + 1 : 0) * settings.chunkSize;
+			expected += dx * dx + dz * dz <= settings.viewDistance * settings.viewDistance;
+		}
+	}
+
+	//Each chunk is uploaded once, plus a few reloads for neighbour LOD changes
+	const int maxFrames = expected * 2;
+	int failures = 0;
+	ew::Camera camera;
+	const ew::Vec3 positions[] = { ew::Vec3(0), ew::Vec3(200, 0, -40) };
+	for (const ew::Vec3& position : positions) {
+		camera.position = position;
+		const int frames = settle(terrain, camera, maxFrames);
+		printf("camera (%g, %g): %d chunks loaded of %d after %d frames\n", position.x, position.z, terrain.getNumLoadedChunks(), expected, frames);
+		if (frames < 0 || terrain.getNumLoadedChunks() < expected) {
+			printf("FAIL streaming did not settle\n");
+			failures++;
+		}
+	}
+	return failures > 0 ? 1 : 0;
+}
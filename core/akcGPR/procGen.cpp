@@ -1,94 +1,115 @@
 //procGen.h
 #pragma once
 #include "procGen.h"
+#include <vector>
 namespace akcGPR {
-	ew::MeshData createSphere(float radius, int numSegments)
-	{
-		ew::MeshData mData;
-		ew::Vertex v;
+	// rows are handed out to the pool in ranges of about this many vertices
+	const size_t VERTICES_PER_TASK = 16384;
 
-		const float thetaStep = (2 * ew::PI) / numSegments;
-		const float phiStep = ew::PI / numSegments;
+	static size_t rowsPerTask(int columns)
+	{
+		return VERTICES_PER_TASK / columns + 1;
+	}
 
-		// vertices -------------------------
-		for(int row = 0; row <= numSegments; row++)
+	ew::MeshData createSphere(float radius, int numSegments, ew::ThreadPool* pool)
+	{
+		if(numSegments < 2)
 		{
-			float phi = row * phiStep;
-
-			for(int col = 0; col <= numSegments; col++)
-			{
-				float theta = col * thetaStep;
-
-				v.pos.x = radius * cos(theta) * sin(phi);
-				v.pos.y = radius * cos(phi);
-				v.pos.z = radius * sin(theta) * sin(phi);
-
-				mData.vertices.push_back(v);
-			}
+			numSegments = 2;
+			printf("Number of segments for sphere <2, numSegments set to 2\n");
 		}
+		if(pool == nullptr)
+			pool = &ew::ThreadPool::getShared();
 
-		// indices -------------------------
-		const int poleStart = 0;
+		ew::MeshData mData;
 		const int columns = numSegments + 1;
+		const float thetaStep = (2 * ew::PI) / numSegments;
+		const float phiStep = ew::PI / numSegments;
+		const float uvStep = 1.0f / numSegments; // percentage of plane that each row/column occupies
 
-		// top cap
-		for(int i = 0; i < numSegments; i++)
-		{
-			mData.indices.push_back(columns + i);
-			mData.indices.push_back(poleStart + i);
-			mData.indices.push_back(columns + i + 1);
-		}
-
-		// rows
-		for(int row = 1; row < numSegments; row++)
-		{
-			for(int col = 0; col < numSegments; col++)
-			{
-				int start = columns * row + col;
-
-				// triangle 1
-				mData.indices.push_back(start);
-				mData.indices.push_back(start + 1);
-				mData.indices.push_back(start + columns);
-
-				// triangle 2
-				mData.indices.push_back(start + 1);
-				mData.indices.push_back(start + columns + 1);
-				mData.indices.push_back(start + columns);
-			}
-		}
-
-		// bottom cap
-		for(int i = 0; i < numSegments; i++)
-		{
-			int element = i + mData.vertices.size() - (numSegments * 2);
-
-			mData.indices.push_back(columns + element + 1);
-			mData.indices.push_back(poleStart + element);
-			mData.indices.push_back(columns + element);
-		}
+		// everything is sized up front so rows can be written independently
+		// (numSegments + 1)^2 vertices, 3 * numSegments indices per cap and 6 * numSegments per row in between
+		mData.vertices.resize((size_t)columns * columns);
+		mData.indices.resize((size_t)6 * numSegments * (numSegments - 1));
 
-		// normals -------------------------
-		for(int i = 0; i < mData.vertices.size(); i++)
+		// the same angles repeat on every row
+		std::vector<float> cosTheta(columns), sinTheta(columns);
+		for(int col = 0; col <= numSegments; col++)
 		{
-			// for spheres, normal is just normalized position of point
-			mData.vertices[i].normal = ew::Normalize(mData.vertices[i].pos);
+			cosTheta[col] = cos(col * thetaStep);
+			sinTheta[col] = sin(col * thetaStep);
 		}
 
-		// UVs -------------------------
-		float uvStep = 1.0f / numSegments; // percentage of plane that each row/column occupies
-		for(int row = 0; row <= numSegments; row++)
+		pool->parallelFor(columns, rowsPerTask(columns), [&](size_t firstRow, size_t endRow)
 		{
-			for(int col = 0; col <= numSegments; col++)
+			for(int row = (int)firstRow; row < (int)endRow; row++)
 			{
-				// calculate element number of each vertex
-				int element = row * (numSegments + 1) + col;
-
-				// row/column number * uvStep == uv position of vertex
-				mData.vertices[element].uv.x = col * uvStep;
-				mData.vertices[element].uv.y = row * uvStep;
+				// vertices -------------------------
+				const float phi = row * phiStep;
+				const float sinPhi = sin(phi);
+				const float cosPhi = cos(phi);
+				ew::Vertex* v = &mData.vertices[(size_t)row * columns];
+
+				for(int col = 0; col <= numSegments; col++, v++)
+				{
+					// for spheres, normal is just normalized position of point
+					v->normal = ew::Vec3(cosTheta[col] * sinPhi, cosPhi, sinTheta[col] * sinPhi);
+					v->pos = v->normal * radius;
+					v->uv = ew::Vec2(col * uvStep, row * uvStep);
+				}
+
+				// indices -------------------------
+				// vertex row r starts the band of triangles below it. The first and last rows of
+				// vertices are single points, so the cap bands only need one triangle per column
+				if(row == numSegments)
+					continue;
+				const int start = columns * row;
+				unsigned int* index = &mData.indices[row == 0 ? 0 : (size_t)3 * numSegments + (size_t)(row - 1) * 6 * numSegments];
+
+				if(row == 0)
+				{
+					// top cap
+					for(int i = 0; i < numSegments; i++)
+					{
+						*index++ = columns + i;
+						*index++ = i;
+						*index++ = columns + i + 1;
+					}
+				}
+				else if(row == numSegments - 1)
+				{
+					// bottom cap
+					for(int i = 0; i < numSegments; i++)
+					{
+						*index++ = start + i;
+						*index++ = start + i + 1;
+						*index++ = columns + start + i;
+					}
+				}
+				else
+				{
+					// rows
+					for(int col = 0; col < numSegments; col++)
+					{
+						const unsigned int s = start + col;
+
+						// triangle 1
+						*index++ = s;
+						*index++ = s + 1;
+						*index++ = s + columns;
+
+						// triangle 2
+						*index++ = s + 1;
+						*index++ = s + columns + 1;
+						*index++ = s + columns;
+					}
+				}
 			}
-		}
+		});
+
+		// bounds -------------------------
+		mData.bounds = ew::Bounds(ew::Vec3(-radius), ew::Vec3(radius));
+		mData.bounds.radius = radius;
 
 		return mData;
 	}
@@ -103,65 +124,62 @@ namespace akcGPR {
 		}
 
 		ew::MeshData mData;
-		ew::Vertex v;
 		const float topY = height / 2.0f;
 		const float thetaStep = (2 * ew::PI) / numSegments;
+		const float uvStep = 1.0f / numSegments; // percentage of plane that each row/column occupies
+		const int columns = numSegments + 1;
 
-		// vertices -------------------------
-		
-		// top center point
-		v.pos.x = 0.0f; v.pos.y = topY; v.pos.z = 0.0f;
-		mData.vertices.push_back(v);
-
-		// top ring points
-		for(int i = 0; i <= numSegments; i++)
-		{
-			float theta = i * thetaStep;
+		// vertex layout: top center, top ring, bottom ring, bottom center,
+		// then the rings again with side normals - need duplicate vertices for normals
+		const int topCenter = 0;
+		const int topStart = 1;
+		const int botStart = topStart + columns;
+		const int botCenter = botStart + columns;
+		const int sideStart = botCenter + 1;
 
-			v.pos.x = cos(theta) * radius;
-			v.pos.y = topY;
-			v.pos.z = sin(theta) * radius;
+		mData.vertices.resize((size_t)sideStart + 2 * columns);
+		mData.indices.reserve((size_t)12 * numSegments);
 
-			mData.vertices.push_back(v);
-		}
+		// vertices -------------------------
+		ew::Vertex* vertices = mData.vertices.data();
+		vertices[topCenter].pos = ew::Vec3(0.0f, topY, 0.0f);
+		vertices[topCenter].normal = ew::Vec3(0.0f, 1.0f, 0.0f);
+		vertices[topCenter].uv = ew::Vec2(0.5f, 0.5f);
+		vertices[botCenter].pos = ew::Vec3(0.0f, -topY, 0.0f);
+		vertices[botCenter].normal = ew::Vec3(0.0f, -1.0f, 0.0f);
+		vertices[botCenter].uv = ew::Vec2(0.5f, 0.5f);
 
-		// bottom ring points
 		for(int i = 0; i <= numSegments; i++)
 		{
-			float theta = i * thetaStep;
-
-			v.pos.x = cos(theta) * radius;
-			v.pos.y = -topY;
-			v.pos.z = sin(theta) * radius;
-
-			mData.vertices.push_back(v);
-		}
-
-		// bottom center point
-		v.pos.x = 0.0f; v.pos.y = -topY; v.pos.z = 0.0f;
-		mData.vertices.push_back(v);
-
-		// top ring and bottom ring pt2 - need duplicate vertices for normals
-		const int verticesOriginalSize = mData.vertices.size();
-
-		for(int i = 1; i <= verticesOriginalSize - 2; i++)
-		{
-			v.pos.x = mData.vertices[i].pos.x;
-			v.pos.y = mData.vertices[i].pos.y;
-			v.pos.z = mData.vertices[i].pos.z;
-
-			mData.vertices.push_back(v);
+			const float theta = i * thetaStep;
+			const float x = cos(theta);
+			const float z = sin(theta);
+
+			// caps: flat normals, uvs project the ring onto the unit square
+			ew::Vertex& top = vertices[topStart + i];
+			top.pos = ew::Vec3(x * radius, topY, z * radius);
+			top.normal = ew::Vec3(0.0f, 1.0f, 0.0f);
+			top.uv = ew::Vec2((x + 1.0f) * 0.5f, (z + 1.0f) * 0.5f);
+
+			ew::Vertex& bot = vertices[botStart + i];
+			bot.pos = ew::Vec3(x * radius, -topY, z * radius);
+			bot.normal = ew::Vec3(0.0f, -1.0f, 0.0f);
+			bot.uv = top.uv;
+
+			// sides: normals point straight out from the axis
+			ew::Vertex& sideTop = vertices[sideStart + i];
+			sideTop.pos = top.pos;
+			sideTop.normal = ew::Vec3(x, 0.0f, z);
+			sideTop.uv = ew::Vec2(i * uvStep, 1.0f);
+
+			ew::Vertex& sideBot = vertices[sideStart + columns + i];
+			sideBot.pos = bot.pos;
+			sideBot.normal = sideTop.normal;
+			sideBot.uv = ew::Vec2(i * uvStep, 0.0f);
 		}
 
 		// indices -------------------------
 
-		const int topCenter = 0;
-		const int topStart = 1;
-		const int botCenter = verticesOriginalSize - 1;
-		const int botStart = verticesOriginalSize / 2;
-		const int sideStart = verticesOriginalSize;
-		const int columns = numSegments + 1;
-
 		// top ring triangles
 		for(int i = 0; i < numSegments; i++)
 		{
@@ -171,7 +189,7 @@ namespace akcGPR {
 		}
 
 		// side triangles
-		for(int i = 0; i < columns; i++)
+		for(int i = 0; i < numSegments; i++)
 		{
 			int start = sideStart + i;
 
@@ -194,86 +212,14 @@ namespace akcGPR {
 			mData.indices.push_back(botStart + i);
 		}
 
-		// normals -------------------------
-		
-		// top center and top ring
-		for(int i = 0; i <= numSegments; i++)
-		{
-			mData.vertices[i].normal = ew::Vec3(0.0f, 1.0f, 0.0f);
-		}
-
-		// bottom ring and bottom center
-		for(int i = 0; i <= numSegments + 1; i++)
-		{
-			mData.vertices[i + numSegments + 1].normal = ew::Vec3(0.0f, -1.0f, 0.0f);
-		}
-
-		// top ring pt2
-		for(int i = 0; i <= numSegments; i++)
-		{
-			ew::Vec3 normalVec;
-			int element = i + sideStart;
-
-			normalVec.x = mData.vertices[element].pos.x - mData.vertices[topCenter].pos.x;
-			normalVec.y = mData.vertices[element].pos.y - mData.vertices[topCenter].pos.y;
-			normalVec.z = mData.vertices[element].pos.z - mData.vertices[topCenter].pos.z;
-			
-			mData.vertices[element].normal = ew::Normalize(normalVec);
-		}
-
-		// bottom ring pt2
-		for(int i = 0; i <= numSegments; i++)
-		{
-			ew::Vec3 normalVec;
-			int element = i + sideStart + numSegments + 1;
-
-			normalVec.x = mData.vertices[element].pos.x - mData.vertices[botCenter].pos.x;
-			normalVec.y = mData.vertices[element].pos.y - mData.vertices[botCenter].pos.y;
-			normalVec.z = mData.vertices[element].pos.z - mData.vertices[botCenter].pos.z;
-
-			mData.vertices[element].normal = ew::Normalize(normalVec);
-		}
-
-		// UVs -------------------------
-		
-		// top center
-		mData.vertices[topCenter].uv = ew::Vec2(0.5f, 0.5f);
-
-		// top ring and bottom ring pt1
-		for(int i = topStart; i < botCenter; i++)
-		{
-			mData.vertices[i].uv = ew::Vec2(
-				(mData.vertices[i].pos.x / radius) + 1.0f * 0.5f,
-				(mData.vertices[i].pos.z / radius) + 1.0f * 0.5f
-			);
-		}
-
-		// bottom center
-		mData.vertices[botCenter].uv = ew::Vec2(0.5f, 0.5f);
-
-		// top ring pt2
-		float uvStep = 1.0f / numSegments; // percentage of plane that each row/column occupies
-		for(int i = 0; i <= numSegments; i++)
-		{
-			int element = i + sideStart;
-
-			mData.vertices[element].uv.x = i * uvStep;
-			mData.vertices[element].uv.y = 1.0f;
-		}
-		
-		// bottom ring pt2
-		for(int i = 0; i <= numSegments; i++)
-		{
-			int element = i + sideStart + numSegments + 1;
-
-			mData.vertices[element].uv.x = i * uvStep;
-			mData.vertices[element].uv.y = 0.0f;
-		}
+		// bounds -------------------------
+		mData.bounds = ew::Bounds(ew::Vec3(-radius, -topY, -radius), ew::Vec3(radius, topY, radius));
+		mData.bounds.radius = sqrtf(radius * radius + topY * topY);
 
 		return mData;
 	}
 
-	ew::MeshData createPlane(float width, float height, int subdivisions)
+	ew::MeshData createPlane(float width, float height, int subdivisions, ew::ThreadPool* pool)
 	{
 		// <1 subdivisions doesn't make sense and breaks code
 		if(subdivisions < 1)
@@ -281,69 +227,58 @@ namespace akcGPR {
 			subdivisions = 1;
 			printf("Subdivisions for plane <1, subdivisions set to 1\n");
 		}
+		if(pool == nullptr)
+			pool = &ew::ThreadPool::getShared();
 
 		ew::MeshData mData;
-		ew::Vertex v;
 		const int columns = subdivisions + 1;
+		const float uvStep = 1.0f / subdivisions; // percentage of plane that each row/column occupies
 
-		// vertices -------------------------
-		for(int row = 0; row <= subdivisions; row++)
-		{
-			for(int col = 0; col <= subdivisions; col++)
-			{
-				v.pos.x = width * ((float)col / subdivisions);
-				v.pos.z = -height * ((float)row / subdivisions);
-				mData.vertices.push_back(v);
-			}
-		}
-
-		// indices -------------------------
-		for(int row = 0; row < subdivisions; row++)
-		{
-			for(int col = 0; col < subdivisions; col++)
-			{
-				int start = row * columns + col;
-
-				// bottom right triangle
-				mData.indices.push_back(start);
-				mData.indices.push_back(start + 1);
-				mData.indices.push_back(start + columns + 1);
+		mData.vertices.resize((size_t)columns * columns);
+		mData.indices.resize((size_t)6 * subdivisions * subdivisions);
 
-				// top left triangle
-				mData.indices.push_back(start);
-				mData.indices.push_back(start + columns + 1);
-				mData.indices.push_back(start + columns);
-			}
-		}
-
-		// normals -------------------------
-		for(int row = 0; row <= subdivisions; row++)
+		pool->parallelFor(columns, rowsPerTask(columns), [&](size_t firstRow, size_t endRow)
 		{
-			for(int col = 0; col <= subdivisions; col++)
+			for(int row = (int)firstRow; row < (int)endRow; row++)
 			{
-				// calculate element number of each vertex
-				int element = row * (subdivisions + 1) + col;
-
-				// for plane, all vertices have same normal
-				mData.vertices[element].normal = ew::Vec3(0.0, 1.0, 0.0);
+				// vertices -------------------------
+				ew::Vertex* v = &mData.vertices[(size_t)row * columns];
+				const float z = -height * ((float)row / subdivisions);
+
+				for(int col = 0; col <= subdivisions; col++, v++)
+				{
+					v->pos = ew::Vec3(width * ((float)col / subdivisions), 0.0f, z);
+					// for plane, all vertices have same normal
+					v->normal = ew::Vec3(0.0f, 1.0f, 0.0f);
+					// row/column number * uvStep == uv position of vertex
+					v->uv = ew::Vec2(col * uvStep, row * uvStep);
+				}
+
+				// indices -------------------------
+				if(row == subdivisions)
+					continue;
+				unsigned int* index = &mData.indices[(size_t)row * 6 * subdivisions];
+
+				for(int col = 0; col < subdivisions; col++)
+				{
+					const unsigned int start = row * columns + col;
+
+					// bottom right triangle
+					*index++ = start;
+					*index++ = start + 1;
+					*index++ = start + columns + 1;
+
+					// top left triangle
+					*index++ = start;
+					*index++ = start + columns + 1;
+					*index++ = start + columns;
+				}
 			}
-		}
-
-		// UVs -------------------------
-		float uvStep = 1.0f / subdivisions; // percentage of plane that each row/column occupies
-		for(int row = 0; row <= subdivisions; row++)
-		{
-			for(int col = 0; col <= subdivisions; col++)
-			{
-				// calculate element number of each vertex
-				int element = row * (subdivisions + 1) + col;
+		});
 
-				// row/column number * uvStep == uv position of vertex
-				mData.vertices[element].uv.x = col * uvStep;
-				mData.vertices[element].uv.y = row * uvStep;
-			}
-		}
+		// bounds -------------------------
+		mData.bounds = ew::Bounds(ew::Vec3(0.0f, 0.0f, -height), ew::Vec3(width, 0.0f, 0.0f));
 
 		return mData;
 	}
-}
\ No newline at end of file
+}
@@ -1,8 +1,10 @@
 //procGen.h
 #pragma once
 #include "../ew/mesh.h"
+#include "../ew/threadPool.h"
 namespace akcGPR {
-	ew::MeshData createSphere(float radius, int numSegments);
+	// rows are generated in parallel on pool (nullptr = ew::ThreadPool::getShared())
+	ew::MeshData createSphere(float radius, int numSegments, ew::ThreadPool* pool = nullptr);
 	ew::MeshData createCylinder(float height, float radius, int numSegments);
-	ew::MeshData createPlane(float width, float height, int subdivisions);
+	ew::MeshData createPlane(float width, float height, int subdivisions, ew::ThreadPool* pool = nullptr);
 }
\ No newline at end of file
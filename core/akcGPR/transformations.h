@@ -71,7 +71,7 @@ namespace akcGPR {
 	};
 	*/
 
-	inline ew::Mat4 LookAt(ew::Vec3 eye, ew::Vec3 target, ew::Vec3 up)
+	constexpr ew::Mat4 LookAt(ew::Vec3 eye, ew::Vec3 target, ew::Vec3 up)
 	{
 		// calculating rotation basis vectors
 		ew::Vec3 fBasis = ew::Normalize(eye - target);
@@ -87,7 +87,7 @@ namespace akcGPR {
 		);
 	}
 
-	inline ew::Mat4 Orthographic(float height, float aspect, float near, float far)
+	constexpr ew::Mat4 Orthographic(float height, float aspect, float near, float far)
 	{
 		// symmetrical frustrum doesn't need specific l, r, t, b values
 		return ew::Mat4(
@@ -99,11 +99,11 @@ namespace akcGPR {
 	}
 
 	// fov == vertical aspect ratio in radians
-	inline ew::Mat4 Perspective(float fov, float aspect, float near, float far)
+	constexpr ew::Mat4 Perspective(float fov, float aspect, float near, float far)
 	{
 		return ew::Mat4(
-			1.0 / (tan(fov / 2.0) * aspect),	0,						0,		0,
-			0,									1.0 / tan(fov / 2.0),	0,		0,
+			1.0 / (ew::Tan(fov / 2.0f) * aspect),	0,						0,		0,
+			0,									1.0 / ew::Tan(fov / 2.0f),	0,		0,
 			0,	0, (near + far) / (near - far),	(2.0 * far * near) / (near - far),
 			0,									0,						-1.0,	0
 		);
@@ -115,13 +115,8 @@ namespace akcGPR {
 		ew::Vec3 scale = ew::Vec3(1.0f, 1.0f, 1.0f);
 
 		ew::Mat4 getModelMatrix() const {
-			// matrix multiplication is right-to-left (or in this case, bottom-to-top)
-			return ew::Translate(position)
-				* ew::RotateY(ew::Radians(rotation.y))
-				* ew::RotateX(ew::Radians(rotation.x))
-				* ew::RotateZ(ew::Radians(rotation.z))
-				* ew::Scale(scale)
-				* ew::Identity();
+			// closed form Translate * RotateY * RotateX * RotateZ * Scale
+			return ew::TRS(position, rotation * ew::DEG2RAD, scale);
 		}
 	};
 }
\ No newline at end of file
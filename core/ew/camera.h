@@ -14,10 +14,10 @@ namespace ew {
 		float orthoHeight = 6.0f;
 		float aspectRatio = 1.77f;
 
-		inline ew::Mat4 ViewMatrix()const {
+		constexpr ew::Mat4 ViewMatrix()const {
 			return ew::LookAt(position, target, ew::Vec3(0, 1, 0));
 		}
-		inline ew::Mat4 ProjectionMatrix()const {
+		constexpr ew::Mat4 ProjectionMatrix()const {
 
 			if (orthographic) {
 				return ew::Orthographic(orthoHeight, aspectRatio, nearPlane, farPlane);
@@ -0,0 +1,154 @@
+#include "dynamicMesh.h"
+#include <string.h>
+#include "external/glad.h"
+
+namespace ew {
+	DynamicMesh::DynamicMesh(size_t maxVertices, size_t maxIndices)
+	{
+		create(maxVertices, maxIndices);
+	}
+	DynamicMesh::~DynamicMesh()
+	{
+		if (m_vao == 0)
+			return;
+		for (void*& fence : m_fences) {
+			if (fence)
+				glDeleteSync((GLsync)fence);
+		}
+		//Deleting a mapped buffer unmaps it
+		glDeleteBuffers(1, &m_vbo);
+		glDeleteBuffers(1, &m_ebo);
+		glDeleteVertexArrays(1, &m_vao);
+	}
+	/// <summary>
+	/// Allocates immutable, persistently mapped vertex and index storage for NUM_REGIONS copies of the mesh.
+	/// </summary>
+	/// <param name="maxVertices">Vertex capacity</param>
+	/// <param name="maxIndices">Index capacity</param>
+	void DynamicMesh::create(size_t maxVertices, size_t maxIndices)
+	{
+		if (m_vao != 0)
+			return;
+		m_maxVertices = maxVertices;
+		m_maxIndices = maxIndices;
+		m_vertices.resize(maxVertices);
+		m_indices.resize(maxIndices);
+
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		const GLsizeiptr vertexBytes = sizeof(Vertex) * maxVertices * NUM_REGIONS;
+		const GLsizeiptr indexBytes = sizeof(unsigned int) * maxIndices * NUM_REGIONS;
+
+		glGenVertexArrays(1, &m_vao);
+		glBindVertexArray(m_vao);
+
+		glGenBuffers(1, &m_vbo);
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		glBufferStorage(GL_ARRAY_BUFFER, vertexBytes, NULL, flags);
+		m_mappedVertices = (Vertex*)glMapBufferRange(GL_ARRAY_BUFFER, 0, vertexBytes, flags);
+
+		glGenBuffers(1, &m_ebo);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+		glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, indexBytes, NULL, flags);
+		m_mappedIndices = (unsigned int*)glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, indexBytes, flags);
+
+		//Same layout as Mesh. Regions are selected with base vertex and index offsets at draw time
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, pos));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, normal));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, uv));
+		glEnableVertexAttribArray(2);
+
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+	void DynamicMesh::update(const MeshData& meshData)
+	{
+		m_numVertices = 0;
+		m_numIndices = 0;
+		updateVertices(0, meshData.vertices.data(), meshData.vertices.size());
+		updateIndices(0, meshData.indices.data(), meshData.indices.size());
+		m_bounds = meshData.bounds;
+	}
+	void DynamicMesh::updateVertices(size_t first, const Vertex* vertices, size_t count)
+	{
+		if (first >= m_maxVertices || count == 0)
+			return;
+		count = count < m_maxVertices - first ? count : m_maxVertices - first;
+		beginWrite();
+		memcpy(m_vertices.data() + first, vertices, sizeof(Vertex) * count);
+		for (DirtyRange& range : m_dirtyVertices)
+			range.add(first, count);
+		if (first + count > m_numVertices)
+			m_numVertices = first + count;
+	}
+	void DynamicMesh::updateIndices(size_t first, const unsigned int* indices, size_t count)
+	{
+		if (first >= m_maxIndices || count == 0)
+			return;
+		count = count < m_maxIndices - first ? count : m_maxIndices - first;
+		beginWrite();
+		memcpy(m_indices.data() + first, indices, sizeof(unsigned int) * count);
+		for (DirtyRange& range : m_dirtyIndices)
+			range.add(first, count);
+		if (first + count > m_numIndices)
+			m_numIndices = first + count;
+	}
+	/// <summary>
+	/// Called before new data is written. If the current region has been drawn, it is fenced and the next region becomes current,
+	/// so data in flight is never modified. Several updates between two draws all land in the same region.
+	/// </summary>
+	void DynamicMesh::beginWrite()
+	{
+		if (!m_regionInUse)
+			return;
+		m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_region = (m_region + 1) % NUM_REGIONS;
+		m_regionInUse = false;
+	}
+	/// <summary>
+	/// Waits until the GPU is done with the current region, then copies in whatever changed since it was last used.
+	/// With three regions the wait is normally already satisfied.
+	/// </summary>
+	void DynamicMesh::prepareRegion()
+	{
+		GLsync fence = (GLsync)m_fences[m_region];
+		if (fence) {
+			GLenum result = glClientWaitSync(fence, 0, 0);
+			while (result == GL_TIMEOUT_EXPIRED) {
+				result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); //1ms
+			}
+			glDeleteSync(fence);
+			m_fences[m_region] = nullptr;
+		}
+
+		DirtyRange& vertices = m_dirtyVertices[m_region];
+		if (vertices.end > vertices.begin) {
+			memcpy(m_mappedVertices + m_region * m_maxVertices + vertices.begin, m_vertices.data() + vertices.begin, sizeof(Vertex) * (vertices.end - vertices.begin));
+			vertices = DirtyRange();
+		}
+		DirtyRange& indices = m_dirtyIndices[m_region];
+		if (indices.end > indices.begin) {
+			memcpy(m_mappedIndices + m_region * m_maxIndices + indices.begin, m_indices.data() + indices.begin, sizeof(unsigned int) * (indices.end - indices.begin));
+			indices = DirtyRange();
+		}
+		m_regionInUse = true;
+	}
+	void DynamicMesh::draw(ew::DrawMode drawMode)
+	{
+		if (m_vao == 0)
+			return;
+		if (!m_regionInUse)
+			prepareRegion();
+		glBindVertexArray(m_vao);
+		if (drawMode == DrawMode::TRIANGLES) {
+			//Indices are relative to their region, so offset them by the region's first vertex
+			const void* indexOffset = (const void*)(sizeof(unsigned int) * m_region * m_maxIndices);
+			glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)m_numIndices, GL_UNSIGNED_INT, indexOffset, (GLint)(m_region * m_maxVertices));
+		}
+		else {
+			glDrawArrays(GL_POINTS, (GLint)(m_region * m_maxVertices), (GLsizei)m_numVertices);
+		}
+	}
+}
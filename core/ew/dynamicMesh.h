@@ -0,0 +1,75 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+
+namespace ew {
+	//Mesh for geometry that changes every frame (CPU animation, deformation).
+	//Storage is allocated once with glBufferStorage and stays persistently mapped. The buffers hold
+	//NUM_REGIONS copies of the mesh so the CPU can write one copy while the GPU is still reading the others.
+	//Fences make sure a copy is never overwritten while a draw that reads it is in flight.
+	//Updates only copy the ranges that changed. Requires OpenGL 4.4.
+	class DynamicMesh {
+	public:
+		static const int NUM_REGIONS = 3;
+
+		DynamicMesh() {};
+		DynamicMesh(size_t maxVertices, size_t maxIndices);
+		~DynamicMesh();
+		DynamicMesh(const DynamicMesh&) = delete;
+		DynamicMesh& operator=(const DynamicMesh&) = delete;
+
+		//Allocates storage. Capacity is fixed afterwards
+		void create(size_t maxVertices, size_t maxIndices);
+		//Replaces all vertices and indices. Sizes must fit the capacity
+		void update(const MeshData& meshData);
+		//Overwrites vertices [first, first + count). Grows the vertex count if needed
+		void updateVertices(size_t first, const Vertex* vertices, size_t count);
+		//Overwrites indices [first, first + count). Grows the index count if needed
+		void updateIndices(size_t first, const unsigned int* indices, size_t count);
+		void draw(DrawMode drawMode = DrawMode::TRIANGLES);
+
+		inline int getNumVertices()const { return (int)m_numVertices; }
+		inline int getNumIndices()const { return (int)m_numIndices; }
+		inline const Bounds& getBounds()const { return m_bounds; }
+		//Range updates do not touch the bounds. Set them here if they change
+		inline void setBounds(const Bounds& bounds) { m_bounds = bounds; }
+	private:
+		struct DirtyRange {
+			size_t begin = 0;
+			size_t end = 0;
+			inline void add(size_t first, size_t count) {
+				if (end == begin) {
+					begin = first;
+					end = first + count;
+				}
+				else {
+					begin = first < begin ? first : begin;
+					end = first + count > end ? first + count : end;
+				}
+			}
+		};
+		void beginWrite();
+		void prepareRegion();
+
+		unsigned int m_vao = 0;
+		unsigned int m_vbo = 0;
+		unsigned int m_ebo = 0;
+		Vertex* m_mappedVertices = nullptr;
+		unsigned int* m_mappedIndices = nullptr;
+		size_t m_maxVertices = 0;
+		size_t m_maxIndices = 0;
+		size_t m_numVertices = 0;
+		size_t m_numIndices = 0;
+		Bounds m_bounds;
+
+		//CPU copy of the latest data. Regions are refreshed from it
+		std::vector<Vertex> m_vertices;
+		std::vector<unsigned int> m_indices;
+		//Ranges written since each region was last refreshed
+		DirtyRange m_dirtyVertices[NUM_REGIONS];
+		DirtyRange m_dirtyIndices[NUM_REGIONS];
+		void* m_fences[NUM_REGIONS] = {}; //GLsync, set when a region is retired
+		int m_region = 0;
+		bool m_regionInUse = false; //True once the current region has been drawn
+	};
+}
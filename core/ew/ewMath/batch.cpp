@@ -0,0 +1,124 @@
+#include "batch.h"
+#include <math.h>
+
+namespace ew {
+	/// <summary>
+	/// Transforms count points stored as separate x, y, z arrays by an affine matrix
+	/// </summary>
+	/// <param name="m">Affine transform. Bottom row is ignored</param>
+	/// <param name="inX">Input x components (may alias outX)</param>
+	/// <param name="outX">Output x components</param>
+	/// <param name="count">Number of points in each stream</param>
+	void TransformPoints(const ew::Mat4& m, const float* inX, const float* inY, const float* inZ,
+		float* outX, float* outY, float* outZ, size_t count)
+	{
+		size_t i = 0;
+#if defined(EW_SIMD_AVX)
+		{
+			const __m256 m00 = _mm256_set1_ps(m[0][0]), m10 = _mm256_set1_ps(m[1][0]), m20 = _mm256_set1_ps(m[2][0]), m30 = _mm256_set1_ps(m[3][0]);
+			const __m256 m01 = _mm256_set1_ps(m[0][1]), m11 = _mm256_set1_ps(m[1][1]), m21 = _mm256_set1_ps(m[2][1]), m31 = _mm256_set1_ps(m[3][1]);
+			const __m256 m02 = _mm256_set1_ps(m[0][2]), m12 = _mm256_set1_ps(m[1][2]), m22 = _mm256_set1_ps(m[2][2]), m32 = _mm256_set1_ps(m[3][2]);
+			for (; i + 8 <= count; i += 8) {
+				const __m256 x = _mm256_loadu_ps(inX + i);
+				const __m256 y = _mm256_loadu_ps(inY + i);
+				const __m256 z = _mm256_loadu_ps(inZ + i);
+				_mm256_storeu_ps(outX + i, _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, x), _mm256_mul_ps(m10, y)), _mm256_mul_ps(m20, z)), m30));
+				_mm256_storeu_ps(outY + i, _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m01, x), _mm256_mul_ps(m11, y)), _mm256_mul_ps(m21, z)), m31));
+				_mm256_storeu_ps(outZ + i, _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m02, x), _mm256_mul_ps(m12, y)), _mm256_mul_ps(m22, z)), m32));
+			}
+		}
+#endif
+#if defined(EW_SIMD_SSE)
+		{
+			const __m128 m00 = _mm_set1_ps(m[0][0]), m10 = _mm_set1_ps(m[1][0]), m20 = _mm_set1_ps(m[2][0]), m30 = _mm_set1_ps(m[3][0]);
+			const __m128 m01 = _mm_set1_ps(m[0][1]), m11 = _mm_set1_ps(m[1][1]), m21 = _mm_set1_ps(m[2][1]), m31 = _mm_set1_ps(m[3][1]);
+			const __m128 m02 = _mm_set1_ps(m[0][2]), m12 = _mm_set1_ps(m[1][2]), m22 = _mm_set1_ps(m[2][2]), m32 = _mm_set1_ps(m[3][2]);
+			for (; i + 4 <= count; i += 4) {
+				const __m128 x = _mm_loadu_ps(inX + i);
+				const __m128 y = _mm_loadu_ps(inY + i);
+				const __m128 z = _mm_loadu_ps(inZ + i);
+				_mm_storeu_ps(outX + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m10, y)), _mm_mul_ps(m20, z)), m30));
+				_mm_storeu_ps(outY + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, x), _mm_mul_ps(m11, y)), _mm_mul_ps(m21, z)), m31));
+				_mm_storeu_ps(outZ + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, x), _mm_mul_ps(m12, y)), _mm_mul_ps(m22, z)), m32));
+			}
+		}
+#endif
+		//Scalar tail (or everything, without SIMD)
+		for (; i < count; i++) {
+			const float x = inX[i], y = inY[i], z = inZ[i];
+			outX[i] = m[0][0] * x + m[1][0] * y + m[2][0] * z + m[3][0];
+			outY[i] = m[0][1] * x + m[1][1] * y + m[2][1] * z + m[3][1];
+			outZ[i] = m[0][2] * x + m[1][2] * y + m[2][2] * z + m[3][2];
+		}
+	}
+
+	/// <summary>
+	/// Transforms count normals stored as separate x, y, z arrays by the upper 3x3 of normalMatrix and renormalizes them.
+	/// Zero length normals stay zero.
+	/// </summary>
+	/// <param name="normalMatrix">Inverse transpose of the model matrix (or the model matrix itself if it has no non-uniform scale)</param>
+	/// <param name="count">Number of normals in each stream</param>
+	void TransformNormals(const ew::Mat4& normalMatrix, const float* inX, const float* inY, const float* inZ,
+		float* outX, float* outY, float* outZ, size_t count)
+	{
+		const ew::Mat4& m = normalMatrix;
+		size_t i = 0;
+#if defined(EW_SIMD_AVX)
+		{
+			const __m256 m00 = _mm256_set1_ps(m[0][0]), m10 = _mm256_set1_ps(m[1][0]), m20 = _mm256_set1_ps(m[2][0]);
+			const __m256 m01 = _mm256_set1_ps(m[0][1]), m11 = _mm256_set1_ps(m[1][1]), m21 = _mm256_set1_ps(m[2][1]);
+			const __m256 m02 = _mm256_set1_ps(m[0][2]), m12 = _mm256_set1_ps(m[1][2]), m22 = _mm256_set1_ps(m[2][2]);
+			const __m256 zero = _mm256_setzero_ps();
+			for (; i + 8 <= count; i += 8) {
+				const __m256 x = _mm256_loadu_ps(inX + i);
+				const __m256 y = _mm256_loadu_ps(inY + i);
+				const __m256 z = _mm256_loadu_ps(inZ + i);
+				const __m256 nx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, x), _mm256_mul_ps(m10, y)), _mm256_mul_ps(m20, z));
+				const __m256 ny = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m01, x), _mm256_mul_ps(m11, y)), _mm256_mul_ps(m21, z));
+				const __m256 nz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m02, x), _mm256_mul_ps(m12, y)), _mm256_mul_ps(m22, z));
+				const __m256 mag = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, nx), _mm256_mul_ps(ny, ny)), _mm256_mul_ps(nz, nz)));
+				//Masks off the NaNs produced by 0/0
+				const __m256 nonZero = _mm256_cmp_ps(mag, zero, _CMP_NEQ_OQ);
+				_mm256_storeu_ps(outX + i, _mm256_and_ps(_mm256_div_ps(nx, mag), nonZero));
+				_mm256_storeu_ps(outY + i, _mm256_and_ps(_mm256_div_ps(ny, mag), nonZero));
+				_mm256_storeu_ps(outZ + i, _mm256_and_ps(_mm256_div_ps(nz, mag), nonZero));
+			}
+		}
+#endif
+#if defined(EW_SIMD_SSE)
+		{
+			const __m128 m00 = _mm_set1_ps(m[0][0]), m10 = _mm_set1_ps(m[1][0]), m20 = _mm_set1_ps(m[2][0]);
+			const __m128 m01 = _mm_set1_ps(m[0][1]), m11 = _mm_set1_ps(m[1][1]), m21 = _mm_set1_ps(m[2][1]);
+			const __m128 m02 = _mm_set1_ps(m[0][2]), m12 = _mm_set1_ps(m[1][2]), m22 = _mm_set1_ps(m[2][2]);
+			const __m128 zero = _mm_setzero_ps();
+			for (; i + 4 <= count; i += 4) {
+				const __m128 x = _mm_loadu_ps(inX + i);
+				const __m128 y = _mm_loadu_ps(inY + i);
+				const __m128 z = _mm_loadu_ps(inZ + i);
+				const __m128 nx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m10, y)), _mm_mul_ps(m20, z));
+				const __m128 ny = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, x), _mm_mul_ps(m11, y)), _mm_mul_ps(m21, z));
+				const __m128 nz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, x), _mm_mul_ps(m12, y)), _mm_mul_ps(m22, z));
+				const __m128 mag = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz)));
+				const __m128 nonZero = _mm_cmpneq_ps(mag, zero);
+				_mm_storeu_ps(outX + i, _mm_and_ps(_mm_div_ps(nx, mag), nonZero));
+				_mm_storeu_ps(outY + i, _mm_and_ps(_mm_div_ps(ny, mag), nonZero));
+				_mm_storeu_ps(outZ + i, _mm_and_ps(_mm_div_ps(nz, mag), nonZero));
+			}
+		}
+#endif
+		for (; i < count; i++) {
+			const float x = inX[i], y = inY[i], z = inZ[i];
+			const float nx = m[0][0] * x + m[1][0] * y + m[2][0] * z;
+			const float ny = m[0][1] * x + m[1][1] * y + m[2][1] * z;
+			const float nz = m[0][2] * x + m[1][2] * y + m[2][2] * z;
+			const float mag = sqrtf(nx * nx + ny * ny + nz * nz);
+			if (mag == 0) {
+				outX[i] = outY[i] = outZ[i] = 0;
+				continue;
+			}
+			outX[i] = nx / mag;
+			outY[i] = ny / mag;
+			outZ[i] = nz / mag;
+		}
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include "mat4.h"
+
+namespace ew {
+	//Batched transforms over structure-of-arrays x/y/z streams.
+	//Processes 8 (AVX) or 4 (SSE) elements per step with a scalar tail. Input and output may alias.
+
+	//out = m * (x,y,z,1). The bottom row of m is ignored (no perspective divide).
+	void TransformPoints(const ew::Mat4& m, const float* inX, const float* inY, const float* inZ,
+		float* outX, float* outY, float* outZ, size_t count);
+	//out = normalize(mat3(normalMatrix) * (x,y,z))
+	void TransformNormals(const ew::Mat4& normalMatrix, const float* inX, const float* inY, const float* inZ,
+		float* outX, float* outY, float* outZ, size_t count);
+
+	//In place overloads
+	inline void TransformPoints(const ew::Mat4& m, float* x, float* y, float* z, size_t count) {
+		TransformPoints(m, x, y, z, x, y, z, count);
+	}
+	inline void TransformNormals(const ew::Mat4& normalMatrix, float* x, float* y, float* z, size_t count) {
+		TransformNormals(normalMatrix, x, y, z, x, y, z, count);
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <math.h>
+
+//True while the enclosing constexpr function is being evaluated by the compiler.
+//Lets ewMath use SIMD intrinsics and the C math library at runtime while still folding at compile time.
+#if defined(__has_builtin)
+	#if __has_builtin(__builtin_is_constant_evaluated)
+		#define EW_HAS_IS_CONSTANT_EVALUATED 1
+	#endif
+#endif
+#if !defined(EW_HAS_IS_CONSTANT_EVALUATED) && ((defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925))
+	#define EW_HAS_IS_CONSTANT_EVALUATED 1
+#endif
+#if defined(EW_HAS_IS_CONSTANT_EVALUATED)
+	#define EW_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+	//Older compilers: always take the runtime path. Constant evaluation of trig/sqrt/SIMD code will fail to compile.
+	#define EW_IS_CONSTANT_EVALUATED() false
+#endif
+
+namespace ew {
+	namespace detail {
+		constexpr double CONSTEXPR_PI = 3.14159265358979323846;
+
+		//Newton-Raphson square root, accurate to double precision
+		constexpr double ConstexprSqrt(double x) {
+			if (!(x > 0))
+				return 0;
+			double guess = x > 1 ? x : 1;
+			for (int i = 0; i < 128; i++) {
+				double next = 0.5 * (guess + x / guess);
+				if (next >= guess)
+					break;
+				guess = next;
+			}
+			return guess;
+		}
+
+		//Sine via range reduction to [-pi/2, pi/2] and a Taylor series to x^15 (error < 1e-12)
+		constexpr double ConstexprSin(double x) {
+			const double tau = 2.0 * CONSTEXPR_PI;
+			//Reduce to [-pi, pi]
+			long long turns = (long long)(x / tau);
+			x -= (double)turns * tau;
+			if (x > CONSTEXPR_PI) x -= tau;
+			if (x < -CONSTEXPR_PI) x += tau;
+			//Reflect to [-pi/2, pi/2]
+			if (x > CONSTEXPR_PI / 2) x = CONSTEXPR_PI - x;
+			if (x < -CONSTEXPR_PI / 2) x = -CONSTEXPR_PI - x;
+			const double x2 = x * x;
+			double term = x;
+			double sum = x;
+			for (int n = 1; n <= 7; n++) {
+				term *= -x2 / ((2.0 * n) * (2.0 * n + 1.0));
+				sum += term;
+			}
+			return sum;
+		}
+
+		constexpr double ConstexprCos(double x) {
+			return ConstexprSin(x + CONSTEXPR_PI / 2);
+		}
+	}
+
+	//Float math that is usable in constant expressions. Matches the C library exactly at runtime.
+	constexpr float Sqrt(float x) {
+		return EW_IS_CONSTANT_EVALUATED() ? (float)detail::ConstexprSqrt(x) : sqrtf(x);
+	}
+	constexpr float Sin(float rad) {
+		return EW_IS_CONSTANT_EVALUATED() ? (float)detail::ConstexprSin(rad) : sinf(rad);
+	}
+	constexpr float Cos(float rad) {
+		return EW_IS_CONSTANT_EVALUATED() ? (float)detail::ConstexprCos(rad) : cosf(rad);
+	}
+	constexpr float Tan(float rad) {
+		return EW_IS_CONSTANT_EVALUATED() ? (float)(detail::ConstexprSin(rad) / detail::ConstexprCos(rad)) : tanf(rad);
+	}
+}
@@ -0,0 +1,183 @@
+#include "frustum.h"
+#include "simd.h"
+#include <math.h>
+
+namespace ew {
+	static Plane makePlane(float a, float b, float c, float d) {
+		const float mag = sqrtf(a * a + b * b + c * c);
+		Plane plane;
+		if (mag == 0)
+			return plane;
+		plane.normal = ew::Vec3(a, b, c) / mag;
+		plane.distance = d / mag;
+		return plane;
+	}
+
+	/// <summary>
+	/// Extracts the six frustum planes from a combined projection * view matrix (Gribb/Hartmann).
+	/// Planes are in world space, normalized, and point inwards.
+	/// </summary>
+	/// <param name="viewProjection">Projection * View</param>
+	/// <returns></returns>
+	Frustum ExtractFrustum(const ew::Mat4& viewProjection)
+	{
+		const ew::Mat4& m = viewProjection;
+		//Rows of the matrix. Clip space is -w <= x,y,z <= w
+		const ew::Vec4 row0 = ew::Vec4(m[0][0], m[1][0], m[2][0], m[3][0]);
+		const ew::Vec4 row1 = ew::Vec4(m[0][1], m[1][1], m[2][1], m[3][1]);
+		const ew::Vec4 row2 = ew::Vec4(m[0][2], m[1][2], m[2][2], m[3][2]);
+		const ew::Vec4 row3 = ew::Vec4(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+		Frustum frustum;
+		frustum.planes[Frustum::PLANE_LEFT] = makePlane(row3.x + row0.x, row3.y + row0.y, row3.z + row0.z, row3.w + row0.w);
+		frustum.planes[Frustum::PLANE_RIGHT] = makePlane(row3.x - row0.x, row3.y - row0.y, row3.z - row0.z, row3.w - row0.w);
+		frustum.planes[Frustum::PLANE_BOTTOM] = makePlane(row3.x + row1.x, row3.y + row1.y, row3.z + row1.z, row3.w + row1.w);
+		frustum.planes[Frustum::PLANE_TOP] = makePlane(row3.x - row1.x, row3.y - row1.y, row3.z - row1.z, row3.w - row1.w);
+		frustum.planes[Frustum::PLANE_NEAR] = makePlane(row3.x + row2.x, row3.y + row2.y, row3.z + row2.z, row3.w + row2.w);
+		frustum.planes[Frustum::PLANE_FAR] = makePlane(row3.x - row2.x, row3.y - row2.y, row3.z - row2.z, row3.w - row2.w);
+		return frustum;
+	}
+
+	bool IsSphereVisible(const Frustum& frustum, const ew::Vec3& center, float radius)
+	{
+		for (const Plane& plane : frustum.planes) {
+			if (ew::Dot(plane.normal, center) + plane.distance + radius < 0)
+				return false;
+		}
+		return true;
+	}
+
+	bool IsAABBVisible(const Frustum& frustum, const ew::Vec3& center, const ew::Vec3& extents)
+	{
+		for (const Plane& plane : frustum.planes) {
+			//Projected radius of the box onto the plane normal
+			const float r = fabsf(plane.normal.x) * extents.x + fabsf(plane.normal.y) * extents.y + fabsf(plane.normal.z) * extents.z;
+			if (ew::Dot(plane.normal, center) + plane.distance + r < 0)
+				return false;
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Tests many bounding spheres against a frustum. A sphere is culled if it is fully behind any plane.
+	/// </summary>
+	/// <param name="visible">Output, one byte per sphere</param>
+	/// <returns>Number of visible spheres</returns>
+	size_t CullSpheres(const Frustum& frustum, const float* centerX, const float* centerY, const float* centerZ,
+		const float* radius, size_t count, unsigned char* visible)
+	{
+		size_t numVisible = 0;
+		size_t i = 0;
+#if defined(EW_SIMD_AVX)
+		for (; i + 8 <= count; i += 8) {
+			const __m256 x = _mm256_loadu_ps(centerX + i);
+			const __m256 y = _mm256_loadu_ps(centerY + i);
+			const __m256 z = _mm256_loadu_ps(centerZ + i);
+			const __m256 r = _mm256_loadu_ps(radius + i);
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (const Plane& plane : frustum.planes) {
+				__m256 d = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.normal.x), x), _mm256_mul_ps(_mm256_set1_ps(plane.normal.y), y));
+				d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(plane.normal.z), z));
+				d = _mm256_add_ps(_mm256_add_ps(d, _mm256_set1_ps(plane.distance)), r);
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_GE_OQ));
+			}
+			const int mask = _mm256_movemask_ps(inside);
+			for (int j = 0; j < 8; j++) {
+				visible[i + j] = (mask >> j) & 1;
+				numVisible += visible[i + j];
+			}
+		}
+#endif
+#if defined(EW_SIMD_SSE)
+		for (; i + 4 <= count; i += 4) {
+			const __m128 x = _mm_loadu_ps(centerX + i);
+			const __m128 y = _mm_loadu_ps(centerY + i);
+			const __m128 z = _mm_loadu_ps(centerZ + i);
+			const __m128 r = _mm_loadu_ps(radius + i);
+			__m128 inside = _mm_cmpeq_ps(x, x); //All ones (unless NaN)
+			for (const Plane& plane : frustum.planes) {
+				__m128 d = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.normal.x), x), _mm_mul_ps(_mm_set1_ps(plane.normal.y), y));
+				d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(plane.normal.z), z));
+				d = _mm_add_ps(_mm_add_ps(d, _mm_set1_ps(plane.distance)), r);
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(d, _mm_setzero_ps()));
+			}
+			const int mask = _mm_movemask_ps(inside);
+			for (int j = 0; j < 4; j++) {
+				visible[i + j] = (mask >> j) & 1;
+				numVisible += visible[i + j];
+			}
+		}
+#endif
+		for (; i < count; i++) {
+			visible[i] = IsSphereVisible(frustum, ew::Vec3(centerX[i], centerY[i], centerZ[i]), radius[i]) ? 1 : 0;
+			numVisible += visible[i];
+		}
+		return numVisible;
+	}
+
+	/// <summary>
+	/// Tests many axis aligned boxes against a frustum. A box is culled if it is fully behind any plane.
+	/// </summary>
+	/// <param name="extentX">Half size of each box on x</param>
+	/// <param name="visible">Output, one byte per box</param>
+	/// <returns>Number of visible boxes</returns>
+	size_t CullAABBs(const Frustum& frustum, const float* centerX, const float* centerY, const float* centerZ,
+		const float* extentX, const float* extentY, const float* extentZ, size_t count, unsigned char* visible)
+	{
+		size_t numVisible = 0;
+		size_t i = 0;
+#if defined(EW_SIMD_AVX)
+		for (; i + 8 <= count; i += 8) {
+			const __m256 x = _mm256_loadu_ps(centerX + i);
+			const __m256 y = _mm256_loadu_ps(centerY + i);
+			const __m256 z = _mm256_loadu_ps(centerZ + i);
+			const __m256 ex = _mm256_loadu_ps(extentX + i);
+			const __m256 ey = _mm256_loadu_ps(extentY + i);
+			const __m256 ez = _mm256_loadu_ps(extentZ + i);
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (const Plane& plane : frustum.planes) {
+				__m256 d = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.normal.x), x), _mm256_mul_ps(_mm256_set1_ps(plane.normal.y), y));
+				d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(plane.normal.z), z));
+				__m256 r = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(fabsf(plane.normal.x)), ex), _mm256_mul_ps(_mm256_set1_ps(fabsf(plane.normal.y)), ey));
+				r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_set1_ps(fabsf(plane.normal.z)), ez));
+				d = _mm256_add_ps(_mm256_add_ps(d, _mm256_set1_ps(plane.distance)), r);
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_GE_OQ));
+			}
+			const int mask = _mm256_movemask_ps(inside);
+			for (int j = 0; j < 8; j++) {
+				visible[i + j] = (mask >> j) & 1;
+				numVisible += visible[i + j];
+			}
+		}
+#endif
+#if defined(EW_SIMD_SSE)
+		for (; i + 4 <= count; i += 4) {
+			const __m128 x = _mm_loadu_ps(centerX + i);
+			const __m128 y = _mm_loadu_ps(centerY + i);
+			const __m128 z = _mm_loadu_ps(centerZ + i);
+			const __m128 ex = _mm_loadu_ps(extentX + i);
+			const __m128 ey = _mm_loadu_ps(extentY + i);
+			const __m128 ez = _mm_loadu_ps(extentZ + i);
+			__m128 inside = _mm_cmpeq_ps(x, x);
+			for (const Plane& plane : frustum.planes) {
+				__m128 d = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.normal.x), x), _mm_mul_ps(_mm_set1_ps(plane.normal.y), y));
+				d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(plane.normal.z), z));
+				__m128 r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(fabsf(plane.normal.x)), ex), _mm_mul_ps(_mm_set1_ps(fabsf(plane.normal.y)), ey));
+				r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(fabsf(plane.normal.z)), ez));
+				d = _mm_add_ps(_mm_add_ps(d, _mm_set1_ps(plane.distance)), r);
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(d, _mm_setzero_ps()));
+			}
+			const int mask = _mm_movemask_ps(inside);
+			for (int j = 0; j < 4; j++) {
+				visible[i + j] = (mask >> j) & 1;
+				numVisible += visible[i + j];
+			}
+		}
+#endif
+		for (; i < count; i++) {
+			visible[i] = IsAABBVisible(frustum, ew::Vec3(centerX[i], centerY[i], centerZ[i]), ew::Vec3(extentX[i], extentY[i], extentZ[i])) ? 1 : 0;
+			numVisible += visible[i];
+		}
+		return numVisible;
+	}
+}
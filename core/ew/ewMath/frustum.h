@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include "vec3.h"
+#include "mat4.h"
+
+namespace ew {
+	//Points p with Dot(normal, p) + distance >= 0 are on the inside
+	struct Plane {
+		ew::Vec3 normal;
+		float distance = 0;
+	};
+
+	struct Frustum {
+		enum { PLANE_LEFT, PLANE_RIGHT, PLANE_BOTTOM, PLANE_TOP, PLANE_NEAR, PLANE_FAR, NUM_PLANES };
+		Plane planes[NUM_PLANES];
+	};
+
+	//Extracts normalized world space planes from a projection * view matrix (OpenGL clip space)
+	Frustum ExtractFrustum(const ew::Mat4& viewProjection);
+
+	bool IsSphereVisible(const Frustum& frustum, const ew::Vec3& center, float radius);
+	bool IsAABBVisible(const Frustum& frustum, const ew::Vec3& center, const ew::Vec3& extents);
+
+	//Batched tests over structure-of-arrays inputs, 8 (AVX) or 4 (SSE) objects per step.
+	//visible[i] is set to 1 or 0. Returns the number of visible objects.
+	size_t CullSpheres(const Frustum& frustum, const float* centerX, const float* centerY, const float* centerZ,
+		const float* radius, size_t count, unsigned char* visible);
+	//Boxes are given as center and half extents
+	size_t CullAABBs(const Frustum& frustum, const float* centerX, const float* centerY, const float* centerZ,
+		const float* extentX, const float* extentY, const float* extentZ, size_t count, unsigned char* visible);
+}
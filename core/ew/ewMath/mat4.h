@@ -4,44 +4,51 @@
 
 #pragma once
 #include "vec4.h"
+#include "simd.h"
+#include "constexprMath.h"
 #include <cstddef>
 
 namespace ew {
-	struct Mat4 {
+	//Column major, 16 byte aligned so each column can be loaded as one SSE register
+	struct alignas(16) Mat4 {
 	private:
-		float n[4][4];
+		Vec4 n[4]; //Columns
 	public:
-		Mat4() = default;
-		Mat4(float n00)
+		constexpr Mat4() = default;
+		constexpr Mat4(float n00)
+			:n{ Vec4(n00), Vec4(n00), Vec4(n00), Vec4(n00) }
 		{
-			n[0][0] = n00; n[1][0] = n00; n[2][0] = n00; n[3][0] = n00;
-			n[0][1] = n00; n[1][1] = n00; n[2][1] = n00; n[3][1] = n00;
-			n[0][2] = n00; n[1][2] = n00; n[2][2] = n00; n[3][2] = n00;
-			n[0][3] = n00; n[1][3] = n00; n[2][3] = n00; n[3][3] = n00;
 		};
-		Mat4(float n00, float n10, float n20, float n30,
+		constexpr Mat4(float n00, float n10, float n20, float n30,
 			 float n01, float n11, float n21, float n31,
 			 float n02, float n12, float n22, float n32,
 			 float n03, float n13, float n23, float n33)
+			:n{ Vec4(n00, n01, n02, n03), Vec4(n10, n11, n12, n13), Vec4(n20, n21, n22, n23), Vec4(n30, n31, n32, n33) }
 		{
-			n[0][0] = n00; n[1][0] = n10; n[2][0] = n20; n[3][0] = n30;
-			n[0][1] = n01; n[1][1] = n11; n[2][1] = n21; n[3][1] = n31;
-			n[0][2] = n02; n[1][2] = n12; n[2][2] = n22; n[3][2] = n32;
-			n[0][3] = n03; n[1][3] = n13; n[2][3] = n23; n[3][3] = n33;
 		};
-		Mat4(const Vec4& a, const Vec4& b, const Vec4& c, const Vec4& d) {
-			n[0][0] = a.x; n[0][1] = a.y; n[0][2] = a.z; n[0][3] = a.w;
-			n[1][0] = b.x; n[1][1] = b.y; n[1][2] = b.z; n[1][3] = b.w;
-			n[2][0] = c.x; n[2][1] = c.y; n[2][2] = c.z; n[2][3] = c.w;
-			n[3][0] = d.x; n[3][1] = d.y; n[3][2] = d.z; n[3][3] = d.w;
+		constexpr Mat4(const Vec4& a, const Vec4& b, const Vec4& c, const Vec4& d)
+			:n{ a, b, c, d }
+		{
 		}
-		inline Vec4& operator[](int i) {
-			return (*reinterpret_cast<Vec4*>(n[i]));
+		constexpr Vec4& operator[](int i) {
+			return n[i];
 		}
-		inline const Vec4& operator[](int i) const{
-			return (*reinterpret_cast<const Vec4*>(n[i]));
+		constexpr const Vec4& operator[](int i) const{
+			return n[i];
 		}
-		inline friend Vec4 operator * (const Mat4& m, const Vec4& v) {
+		constexpr friend Vec4 operator * (const Mat4& m, const Vec4& v) {
+#if defined(EW_SIMD_SSE)
+			if (!EW_IS_CONSTANT_EVALUATED()) {
+				//Sum of columns scaled by each component of v
+				__m128 r = _mm_mul_ps(_mm_load_ps(&m.n[0].x), _mm_set1_ps(v.x));
+				r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(&m.n[1].x), _mm_set1_ps(v.y)));
+				r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(&m.n[2].x), _mm_set1_ps(v.z)));
+				r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(&m.n[3].x), _mm_set1_ps(v.w)));
+				Vec4 out;
+				_mm_storeu_ps(&out.x, r);
+				return out;
+			}
+#endif
 			return Vec4(
 				m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z + m[3][0] * v.w,
 				m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z + m[3][1] * v.w,
@@ -49,8 +56,43 @@ namespace ew {
 				m[0][3] * v.x + m[1][3] * v.y + m[2][3] * v.z + m[3][3] * v.w
 			);
 		}
-		inline friend Mat4 operator * (const Mat4& l, const Mat4& r) {
+		constexpr friend Mat4 operator * (const Mat4& l, const Mat4& r) {
 			Mat4 m;
+#if defined(EW_SIMD_AVX)
+			if (!EW_IS_CONSTANT_EVALUATED()) {
+				//Two result columns per iteration. Each 128 bit lane holds a copy of a column of l,
+				//and the matching element of r's column j (low lane) or j+1 (high lane) is broadcast across it.
+				const __m256 l0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&l.n[0].x));
+				const __m256 l1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&l.n[1].x));
+				const __m256 l2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&l.n[2].x));
+				const __m256 l3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&l.n[3].x));
+				for (int j = 0; j < 4; j += 2) {
+					const __m256 rc = _mm256_load_ps(&r.n[j].x);
+					__m256 c = _mm256_mul_ps(l0, _mm256_permute_ps(rc, _MM_SHUFFLE(0, 0, 0, 0)));
+					c = _mm256_add_ps(c, _mm256_mul_ps(l1, _mm256_permute_ps(rc, _MM_SHUFFLE(1, 1, 1, 1))));
+					c = _mm256_add_ps(c, _mm256_mul_ps(l2, _mm256_permute_ps(rc, _MM_SHUFFLE(2, 2, 2, 2))));
+					c = _mm256_add_ps(c, _mm256_mul_ps(l3, _mm256_permute_ps(rc, _MM_SHUFFLE(3, 3, 3, 3))));
+					_mm256_store_ps(&m.n[j].x, c);
+				}
+				return m;
+			}
+#elif defined(EW_SIMD_SSE)
+			if (!EW_IS_CONSTANT_EVALUATED()) {
+				//Column j of the result is l * (column j of r)
+				const __m128 l0 = _mm_load_ps(&l.n[0].x);
+				const __m128 l1 = _mm_load_ps(&l.n[1].x);
+				const __m128 l2 = _mm_load_ps(&l.n[2].x);
+				const __m128 l3 = _mm_load_ps(&l.n[3].x);
+				for (int j = 0; j < 4; j++) {
+					__m128 c = _mm_mul_ps(l0, _mm_set1_ps(r.n[j].x));
+					c = _mm_add_ps(c, _mm_mul_ps(l1, _mm_set1_ps(r.n[j].y)));
+					c = _mm_add_ps(c, _mm_mul_ps(l2, _mm_set1_ps(r.n[j].z)));
+					c = _mm_add_ps(c, _mm_mul_ps(l3, _mm_set1_ps(r.n[j].w)));
+					_mm_store_ps(&m.n[j].x, c);
+				}
+				return m;
+			}
+#endif
 			//Row 0
 			m[0][0] = l[0][0] * r[0][0] + l[1][0] * r[0][1] + l[2][0] * r[0][2] + l[3][0] * r[0][3];//dot(l_row_0,r_col_0)
 			m[1][0] = l[0][0] * r[1][0] + l[1][0] * r[1][1] + l[2][0] * r[1][2] + l[3][0] * r[1][3];//dot(l_row_0,r_col_1)
@@ -71,10 +113,10 @@ namespace ew {
 			m[1][3] = l[0][3] * r[1][0] + l[1][3] * r[1][1] + l[2][3] * r[1][2] + l[3][3] * r[1][3];//dot(l_row_3,r_col_1)
 			m[2][3] = l[0][3] * r[2][0] + l[1][3] * r[2][1] + l[2][3] * r[2][2] + l[3][3] * r[2][3];//dot(l_row_3,r_col_2)
 			m[3][3] = l[0][3] * r[3][0] + l[1][3] * r[3][1] + l[2][3] * r[3][2] + l[3][3] * r[3][3];//dot(l_row_3,r_col_3)
-			return m;		  
+			return m;
 		}
 	};
-	inline Mat4 IdentityMatrix() {
+	constexpr Mat4 IdentityMatrix() {
 		return Mat4(
 			1.0f, 0.0f, 0.0f, 0.0f,
 			0.0f, 1.0f, 0.0f, 0.0f,
@@ -82,4 +124,88 @@ namespace ew {
 			0.0f, 0.0f, 0.0f, 1.0f
 		);
 	}
-}
+	constexpr Mat4 Transpose(const Mat4& m) {
+		return Mat4(
+			m[0][0], m[0][1], m[0][2], m[0][3],
+			m[1][0], m[1][1], m[1][2], m[1][3],
+			m[2][0], m[2][1], m[2][2], m[2][3],
+			m[3][0], m[3][1], m[3][2], m[3][3]
+		);
+	}
+	//General 4x4 inverse by cofactor expansion. Returns m unchanged if it is singular.
+	constexpr Mat4 Inverse(const Mat4& m) {
+		//2x2 sub-determinants of the bottom two rows and top two rows
+		const float s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+		const float s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+		const float s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+		const float s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+		const float s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+		const float s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+		const float c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+		const float c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+		const float c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+		const float c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+		const float c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+		const float c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+		const float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		if (det == 0)
+			return m;
+		const float invDet = 1.0f / det;
+		Mat4 r;
+		r[0][0] = (m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * invDet;
+		r[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * invDet;
+		r[0][2] = (m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * invDet;
+		r[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * invDet;
+		r[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * invDet;
+		r[1][1] = (m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * invDet;
+		r[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * invDet;
+		r[1][3] = (m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * invDet;
+		r[2][0] = (m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * invDet;
+		r[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * invDet;
+		r[2][2] = (m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * invDet;
+		r[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * invDet;
+		r[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * invDet;
+		r[3][1] = (m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * invDet;
+		r[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * invDet;
+		r[3][3] = (m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * invDet;
+		return r;
+	}
+	//Inverse of the upper 3x3 of m, returned in the upper 3x3 of an otherwise identity matrix.
+	//Returns identity if the 3x3 is singular.
+	constexpr Mat4 Inverse3x3(const Mat4& m) {
+		//Columns of the inverse are the cross products of the rows' complements
+		const float c00 = m[1][1] * m[2][2] - m[2][1] * m[1][2];
+		const float c01 = m[2][1] * m[0][2] - m[0][1] * m[2][2];
+		const float c02 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+		const float det = m[0][0] * c00 + m[1][0] * c01 + m[2][0] * c02;
+		Mat4 r = IdentityMatrix();
+		if (det == 0)
+			return r;
+		const float invDet = 1.0f / det;
+		r[0][0] = c00 * invDet;
+		r[0][1] = c01 * invDet;
+		r[0][2] = c02 * invDet;
+		r[1][0] = (m[2][0] * m[1][2] - m[1][0] * m[2][2]) * invDet;
+		r[1][1] = (m[0][0] * m[2][2] - m[2][0] * m[0][2]) * invDet;
+		r[1][2] = (m[1][0] * m[0][2] - m[0][0] * m[1][2]) * invDet;
+		r[2][0] = (m[1][0] * m[2][1] - m[2][0] * m[1][1]) * invDet;
+		r[2][1] = (m[2][0] * m[0][1] - m[0][0] * m[2][1]) * invDet;
+		r[2][2] = (m[0][0] * m[1][1] - m[1][0] * m[0][1]) * invDet;
+		return r;
+	}
+	//Inverse of an affine matrix (bottom row 0,0,0,1). Much cheaper than the general Inverse.
+	constexpr Mat4 InverseAffine(const Mat4& m) {
+		Mat4 r = Inverse3x3(m);
+		//Inverse translation = -(R^-1 * t)
+		const Vec4 t = r * Vec4(m[3][0], m[3][1], m[3][2], 0.0f);
+		r[3][0] = -t.x;
+		r[3][1] = -t.y;
+		r[3][2] = -t.z;
+		return r;
+	}
+	//Inverse transpose of the upper 3x3 of a model matrix, for transforming normals into world space.
+	//Use mat3(_NormalMatrix) in shaders.
+	constexpr Mat4 NormalMatrix(const Mat4& model) {
+		return Transpose(Inverse3x3(model));
+	}
+}
\ No newline at end of file
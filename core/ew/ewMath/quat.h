@@ -0,0 +1,148 @@
+#pragma once
+#include <math.h>
+#include "constexprMath.h"
+#include "vec3.h"
+#include "vec4.h"
+#include "mat4.h"
+
+namespace ew {
+	//Rotation quaternion. w is the scalar part.
+	struct Quat {
+		float x, y, z, w;
+
+		constexpr Quat() :x(0), y(0), z(0), w(1) {};
+		constexpr Quat(float x, float y, float z, float w) :x(x), y(y), z(z), w(w) {};
+
+		//Hamilton product. a * b applies b first, then a
+		friend constexpr Quat operator*(const Quat& a, const Quat& b) {
+			return Quat(
+				a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+				a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+				a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+				a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+			);
+		}
+	};
+
+	constexpr float Dot(const Quat& a, const Quat& b) {
+		return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+	}
+
+	//Inverse rotation for unit quaternions
+	constexpr Quat Conjugate(const Quat& q) {
+		return Quat(-q.x, -q.y, -q.z, q.w);
+	}
+
+	constexpr Quat Normalize(const Quat& q) {
+		const float mag = ew::Sqrt(Dot(q, q));
+		if (mag == 0)
+			return Quat();
+		return Quat(q.x / mag, q.y / mag, q.z / mag, q.w / mag);
+	}
+
+	//Rotation of angle radians around a unit length axis
+	constexpr Quat AngleAxis(float angle, const Vec3& axis) {
+		const float s = ew::Sin(angle * 0.5f);
+		return Quat(axis.x * s, axis.y * s, axis.z * s, ew::Cos(angle * 0.5f));
+	}
+
+	//Euler angles in radians, applied in the same order as RotateY * RotateX * RotateZ
+	constexpr Quat FromEuler(const Vec3& rotation) {
+		const float cx = ew::Cos(rotation.x * 0.5f), sx = ew::Sin(rotation.x * 0.5f);
+		const float cy = ew::Cos(rotation.y * 0.5f), sy = ew::Sin(rotation.y * 0.5f);
+		const float cz = ew::Cos(rotation.z * 0.5f), sz = ew::Sin(rotation.z * 0.5f);
+		//qy * qx * qz expanded
+		return Quat(
+			cy * sx * cz + sy * cx * sz,
+			sy * cx * cz - cy * sx * sz,
+			cy * cx * sz - sy * sx * cz,
+			cy * cx * cz + sy * sx * sz
+		);
+	}
+
+	//Inverse of FromEuler. Returns radians, with x (pitch) in [-PI/2, PI/2]
+	inline Vec3 ToEuler(const Quat& q) {
+		//Elements of the rotation matrix (row, column) that the angles can be read back from
+		const float r12 = 2.0f * (q.y * q.z - q.w * q.x);
+		const float sinX = -r12;
+		if (fabsf(sinX) >= 0.9999f) {
+			//Gimbal lock: only y + z (or y - z) is defined, so put it all in y
+			const float r00 = 1.0f - 2.0f * (q.y * q.y + q.z * q.z);
+			const float r20 = 2.0f * (q.x * q.z - q.w * q.y);
+			return Vec3(copysignf(1.5707963f, sinX), atan2f(-r20, r00), 0.0f);
+		}
+		const float r02 = 2.0f * (q.x * q.z + q.w * q.y);
+		const float r22 = 1.0f - 2.0f * (q.x * q.x + q.y * q.y);
+		const float r10 = 2.0f * (q.x * q.y + q.w * q.z);
+		const float r11 = 1.0f - 2.0f * (q.x * q.x + q.z * q.z);
+		return Vec3(asinf(sinX), atan2f(r02, r22), atan2f(r10, r11));
+	}
+
+	//Rotates v by unit quaternion q
+	constexpr Vec3 Rotate(const Quat& q, const Vec3& v) {
+		//v + 2w(u x v) + 2u x (u x v), where u is the vector part
+		const Vec3 u = Vec3(q.x, q.y, q.z);
+		const Vec3 t = ew::Cross(u, v) * 2.0f;
+		return v + t * q.w + ew::Cross(u, t);
+	}
+
+	//Normalized linear interpolation along the shortest path. Cheap, but not constant angular velocity
+	constexpr Quat Nlerp(const Quat& a, const Quat& b, float t) {
+		const float sign = Dot(a, b) < 0 ? -1.0f : 1.0f;
+		return Normalize(Quat(
+			a.x + (b.x * sign - a.x) * t,
+			a.y + (b.y * sign - a.y) * t,
+			a.z + (b.z * sign - a.z) * t,
+			a.w + (b.w * sign - a.w) * t
+		));
+	}
+
+	//Spherical linear interpolation along the shortest path
+	inline Quat Slerp(const Quat& a, const Quat& b, float t) {
+		float cosTheta = Dot(a, b);
+		Quat end = b;
+		if (cosTheta < 0) {
+			cosTheta = -cosTheta;
+			end = Quat(-b.x, -b.y, -b.z, -b.w);
+		}
+		//Nearly parallel, sin(theta) ~ 0
+		if (cosTheta > 0.9995f)
+			return Nlerp(a, end, t);
+		const float theta = acosf(cosTheta);
+		const float invSin = 1.0f / sinf(theta);
+		const float wa = sinf((1.0f - t) * theta) * invSin;
+		const float wb = sinf(t * theta) * invSin;
+		return Quat(
+			a.x * wa + end.x * wb,
+			a.y * wa + end.y * wb,
+			a.z * wa + end.z * wb,
+			a.w * wa + end.w * wb
+		);
+	}
+
+	//Rotation matrix for unit quaternion q
+	constexpr Mat4 ToMat4(const Quat& q) {
+		const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+		const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+		const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+		return Mat4(
+			1.0f - 2.0f * (yy + zz), 2.0f * (xy - wz), 2.0f * (xz + wy), 0.0f,
+			2.0f * (xy + wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz - wx), 0.0f,
+			2.0f * (xz - wy), 2.0f * (yz + wx), 1.0f - 2.0f * (xx + yy), 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+	}
+
+	//Translate * ToMat4(rotation) * Scale, written out directly. No trig.
+	constexpr Mat4 TRS(const Vec3& t, const Quat& q, const Vec3& s) {
+		const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+		const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+		const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+		return Mat4(
+			(1.0f - 2.0f * (yy + zz)) * s.x, 2.0f * (xy - wz) * s.y, 2.0f * (xz + wy) * s.z, t.x,
+			2.0f * (xy + wz) * s.x, (1.0f - 2.0f * (xx + zz)) * s.y, 2.0f * (yz - wx) * s.z, t.y,
+			2.0f * (xz - wy) * s.x, 2.0f * (yz + wx) * s.y, (1.0f - 2.0f * (xx + yy)) * s.z, t.z,
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+	}
+}
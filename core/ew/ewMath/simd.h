@@ -0,0 +1,16 @@
+#pragma once
+
+//SIMD feature detection for ewMath.
+//EW_SIMD_SSE is set whenever SSE is available (always true on x64).
+//EW_SIMD_AVX is set when the compiler targets AVX (see EW_ENABLE_AVX in core/CMakeLists.txt).
+//Define EW_NO_SIMD to force the scalar fallback paths.
+#if !defined(EW_NO_SIMD)
+	#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+		#define EW_SIMD_SSE 1
+		#include <xmmintrin.h>
+	#endif
+	#if defined(EW_SIMD_SSE) && defined(__AVX__)
+		#define EW_SIMD_AVX 1
+		#include <immintrin.h>
+	#endif
+#endif
@@ -8,7 +8,7 @@
 
 namespace ew {
 	//Identity matrix
-	inline ew::Mat4 Identity() {
+	constexpr ew::Mat4 Identity() {
 		return ew::Mat4(
 			1, 0, 0, 0,
 			0, 1, 0, 0,
@@ -17,7 +17,7 @@ namespace ew {
 		);
 	};
 	//Scale on x,y,z axes
-	inline ew::Mat4 Scale(const ew::Vec3& s) {
+	constexpr ew::Mat4 Scale(const ew::Vec3& s) {
 		return ew::Mat4(
 			s.x, 0, 0, 0,
 			0, s.y, 0, 0,
@@ -26,9 +26,9 @@ namespace ew {
 		);
 	};
 	//Rotation around X axis (pitch) in radians
-	inline ew::Mat4 RotateX(float rad) {
-		const float cosA = cosf(rad);
-		const float sinA = sinf(rad);
+	constexpr ew::Mat4 RotateX(float rad) {
+		const float cosA = ew::Cos(rad);
+		const float sinA = ew::Sin(rad);
 		return Mat4(
 			1.0f, 0.0f, 0.0f, 0.0f,
 			0.0f, cosA, -sinA, 0.0f,
@@ -37,9 +37,9 @@ namespace ew {
 		);
 	};
 	//Rotation around Y axis (yaw) in radians
-	inline ew::Mat4 RotateY(float rad) {
-		const float cosA = cosf(rad);
-		const float sinA = sinf(rad);
+	constexpr ew::Mat4 RotateY(float rad) {
+		const float cosA = ew::Cos(rad);
+		const float sinA = ew::Sin(rad);
 		return Mat4(
 			cosA, 0.0f, sinA, 0.0f,
 			0.0f, 1.0f, 0.0f, 0.0f,
@@ -48,9 +48,9 @@ namespace ew {
 		);
 	};
 	//Rotation around Z axis (roll) in radians
-	inline ew::Mat4 RotateZ(float rad) {
-		const float cosA = cosf(rad);
-		const float sinA = sinf(rad);
+	constexpr ew::Mat4 RotateZ(float rad) {
+		const float cosA = ew::Cos(rad);
+		const float sinA = ew::Sin(rad);
 		return Mat4(
 			cosA, -sinA, 0.0f, 0.0f,
 			sinA, cosA, 0.0f, 0.0f,
@@ -59,7 +59,7 @@ namespace ew {
 		);
 	};
 	//Translate x,y,z
-	inline ew::Mat4 Translate(const ew::Vec3& t) {
+	constexpr ew::Mat4 Translate(const ew::Vec3& t) {
 		return Mat4(
 			1.0f, 0.0f, 0.0f, t.x,
 			0.0f, 1.0f, 0.0f, t.y,
@@ -68,7 +68,21 @@ namespace ew {
 		);
 	};
 
-	inline ew::Mat4 LookAt(const ew::Vec3& eyePos, const ew::Vec3& targetPos, const ew::Vec3& up) {
+	//Translate * RotateY(rotation.y) * RotateX(rotation.x) * RotateZ(rotation.z) * Scale, written out directly.
+	//rotation is in radians. Equivalent to the five matrix product, without the four Mat4 multiplies.
+	constexpr ew::Mat4 TRS(const ew::Vec3& t, const ew::Vec3& rotation, const ew::Vec3& s) {
+		const float cx = ew::Cos(rotation.x), sx = ew::Sin(rotation.x);
+		const float cy = ew::Cos(rotation.y), sy = ew::Sin(rotation.y);
+		const float cz = ew::Cos(rotation.z), sz = ew::Sin(rotation.z);
+		return Mat4(
+			(cy * cz + sy * sx * sz) * s.x, (sy * sx * cz - cy * sz) * s.y, (sy * cx) * s.z, t.x,
+			(cx * sz) * s.x,                (cx * cz) * s.y,                (-sx) * s.z,     t.y,
+			(cy * sx * sz - sy * cz) * s.x, (sy * sz + cy * sx * cz) * s.y, (cy * cx) * s.z, t.z,
+			0.0f,                           0.0f,                           0.0f,            1.0f
+		);
+	}
+
+	constexpr ew::Mat4 LookAt(const ew::Vec3& eyePos, const ew::Vec3& targetPos, const ew::Vec3& up) {
 		ew::Vec3 f = ew::Normalize(eyePos - targetPos);
 		ew::Vec3 r = ew::Normalize(ew::Cross(up, f));
 		ew::Vec3 u = ew::Normalize(ew::Cross(f,r));
@@ -80,8 +94,8 @@ namespace ew {
 		return m;
 	}
 
-	inline ew::Mat4 Perspective(float fov, float a, float n, float f) {
-		float c = tanf(fov / 2.0f);
+	constexpr ew::Mat4 Perspective(float fov, float a, float n, float f) {
+		float c = ew::Tan(fov / 2.0f);
 		Mat4 m = Mat4(0);
 		m[0][0] = 1.0f / (c * a); //Scale X
 		m[1][1] = 1.0f / c; //Scale Y
@@ -91,7 +105,7 @@ namespace ew {
 		return m;
 	}
 
-	inline ew::Mat4 Orthographic(float height, float a, float n, float f) {
+	constexpr ew::Mat4 Orthographic(float height, float a, float n, float f) {
 		//Symmetrical bounds based on aspect ratio
 		float t = height / 2;
 		float b = -t;
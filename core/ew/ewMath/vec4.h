@@ -3,59 +3,71 @@
 */
 
 #pragma once
-#include <math.h>
+#include "constexprMath.h"
 #include "vec3.h"
 
 namespace ew {
 	struct Vec4 {
 		float x, y, z, w;
 
-		Vec4() :x(0), y(0), z(0), w(0) {};
-		Vec4(float x) :x(x), y(x), z(x), w(x) {};
-		Vec4(float x, float y, float z, float w) :x(x), y(y), z(z), w(w) {};
-		Vec4(const Vec3& v, float w) :x(v.x), y(v.y), z(v.z), w(w) {};
+		constexpr Vec4() :x(0), y(0), z(0), w(0) {};
+		constexpr Vec4(float x) :x(x), y(x), z(x), w(x) {};
+		constexpr Vec4(float x, float y, float z, float w) :x(x), y(y), z(z), w(w) {};
+		constexpr Vec4(const Vec3& v, float w) :x(v.x), y(v.y), z(v.z), w(w) {};
 
-		inline Vec3 toVec3() const { return ew::Vec3(x, y, z); }
+		constexpr Vec3 toVec3() const { return ew::Vec3(x, y, z); }
 		//Operator overloads
-		Vec4& operator+=(const Vec4& rhs);
-		Vec4& operator-=(const Vec4& rhs);
-		Vec4& operator*=(float rhs);
-		Vec4& operator/=(float rhs);
-
-		friend Vec4 operator+(Vec4 lhs, const Vec4& rhs);
-		friend Vec4 operator-(Vec4 lhs, const Vec4& rhs);
-		friend Vec4 operator*(Vec4 lhs, float rhs);
-		friend Vec4 operator*(float lhs, Vec4 rhs);
-		friend Vec4 operator/(Vec4 lhs, float rhs);
-		friend Vec4 operator-(const Vec4& rhs);
-
-		float& operator[](int i);
-		const float& operator[](int i)const;
+		constexpr Vec4& operator+=(const Vec4& rhs);
+		constexpr Vec4& operator-=(const Vec4& rhs);
+		constexpr Vec4& operator*=(float rhs);
+		constexpr Vec4& operator/=(float rhs);
+
+		friend constexpr Vec4 operator+(Vec4 lhs, const Vec4& rhs);
+		friend constexpr Vec4 operator-(Vec4 lhs, const Vec4& rhs);
+		friend constexpr Vec4 operator*(Vec4 lhs, float rhs);
+		friend constexpr Vec4 operator*(float lhs, Vec4 rhs);
+		friend constexpr Vec4 operator/(Vec4 lhs, float rhs);
+		friend constexpr Vec4 operator-(const Vec4& rhs);
+
+		constexpr float& operator[](int i);
+		constexpr const float& operator[](int i)const;
 	};
-	inline float& ew::Vec4::operator[](int i)
+	constexpr float& ew::Vec4::operator[](int i)
 	{
-		return ((&x)[i]);
+		//Switch rather than pointer arithmetic so indexing also works in constant expressions
+		switch (i) {
+		case 0: return x;
+		case 1: return y;
+		case 2: return z;
+		default: return w;
+		}
 	}
-	inline const float& Vec4::operator[](int i) const
+	constexpr const float& Vec4::operator[](int i) const
 	{
-		return ((&x)[i]);
+		//Switch rather than pointer arithmetic so indexing also works in constant expressions
+		switch (i) {
+		case 0: return x;
+		case 1: return y;
+		case 2: return z;
+		default: return w;
+		}
 	}
 	//Operator overloads
-	inline Vec4& Vec4::operator+=(const Vec4& rhs) {
+	constexpr Vec4& Vec4::operator+=(const Vec4& rhs) {
 		this->x += rhs.x;
 		this->y += rhs.y;
 		this->z += rhs.z;
 		return *this;
 	}
 
-	inline Vec4& Vec4::operator-=(const Vec4& rhs) {
+	constexpr Vec4& Vec4::operator-=(const Vec4& rhs) {
 		this->x -= rhs.x;
 		this->y -= rhs.y;
 		this->z -= rhs.z;
 		return *this;
 	}
 
-	inline Vec4& Vec4::operator*=(float rhs)
+	constexpr Vec4& Vec4::operator*=(float rhs)
 	{
 		this->x *= rhs;
 		this->y *= rhs;
@@ -63,58 +75,58 @@ namespace ew {
 		return *this;
 	}
 
-	inline Vec4& Vec4::operator/=(float rhs)
+	constexpr Vec4& Vec4::operator/=(float rhs)
 	{
 		*this *= (1.0f / rhs);
 		return *this;
 	}
 
-	inline Vec4 operator+(Vec4 lhs, const Vec4& rhs)
+	constexpr Vec4 operator+(Vec4 lhs, const Vec4& rhs)
 	{
 		lhs += rhs;
 		return lhs;
 	}
 
-	inline Vec4 operator-(Vec4 lhs, const Vec4& rhs)
+	constexpr Vec4 operator-(Vec4 lhs, const Vec4& rhs)
 	{
 		lhs -= rhs;
 		return lhs;
 	}
 
-	inline Vec4 operator*(Vec4 lhs, float rhs)
+	constexpr Vec4 operator*(Vec4 lhs, float rhs)
 	{
 		lhs *= rhs;
 		return lhs;
 	}
 
-	inline Vec4 operator*(float lhs, Vec4 rhs)
+	constexpr Vec4 operator*(float lhs, Vec4 rhs)
 	{
 		rhs *= lhs;
 		return rhs;
 	}
 
-	inline Vec4 operator/(Vec4 lhs, float rhs)
+	constexpr Vec4 operator/(Vec4 lhs, float rhs)
 	{
 		lhs /= rhs;
 		return lhs;
 	}
 
-	inline Vec4 operator-(const Vec4& rhs)
+	constexpr Vec4 operator-(const Vec4& rhs)
 	{
 		return rhs * -1.0f;
 	}
 
 	//Utility functions
-	inline float Dot(const Vec4& a, const Vec4& b) {
+	constexpr float Dot(const Vec4& a, const Vec4& b) {
 		return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
 	}
 
-	inline float Magnitude(const Vec4& v)
+	constexpr float Magnitude(const Vec4& v)
 	{
-		return sqrtf(v.x * v.x + v.y * v.y + v.z * v.z + v.w * v.w);
+		return ew::Sqrt(v.x * v.x + v.y * v.y + v.z * v.z + v.w * v.w);
 	}
 
-	inline Vec4 Normalize(const Vec4& v)
+	constexpr Vec4 Normalize(const Vec4& v)
 	{
 		float mag = Magnitude(v);
 		if (mag == 0)
@@ -0,0 +1,122 @@
+#include "mappedFile.h"
+#include <stdio.h>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ew {
+	MappedFile::MappedFile(const char* filePath)
+	{
+		open(filePath);
+	}
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this == &other)
+			return *this;
+		close();
+		m_data = other.m_data;
+		m_size = other.m_size;
+		m_open = other.m_open;
+		other.m_data = nullptr;
+		other.m_size = 0;
+		other.m_open = false;
+		return *this;
+	}
+	/// <summary>
+	/// Maps the file read only. The file handle is closed right away, the mapping keeps the contents available.
+	/// </summary>
+	/// <param name="filePath"></param>
+	/// <returns></returns>
+	bool MappedFile::open(const char* filePath)
+	{
+		close();
+#ifdef _WIN32
+		HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file == INVALID_HANDLE_VALUE) {
+			printf("Failed to open file %s\n", filePath);
+			return false;
+		}
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size)) {
+			CloseHandle(file);
+			printf("Failed to read size of %s\n", filePath);
+			return false;
+		}
+		m_size = (size_t)size.QuadPart;
+		if (m_size > 0) {
+			HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (mapping != NULL) {
+				m_data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				CloseHandle(mapping);
+			}
+			if (m_data == nullptr) {
+				CloseHandle(file);
+				m_size = 0;
+				printf("Failed to map file %s\n", filePath);
+				return false;
+			}
+		}
+		CloseHandle(file);
+#else
+		const int file = ::open(filePath, O_RDONLY);
+		if (file < 0) {
+			printf("Failed to open file %s\n", filePath);
+			return false;
+		}
+		struct stat info;
+		if (fstat(file, &info) != 0) {
+			::close(file);
+			printf("Failed to read size of %s\n", filePath);
+			return false;
+		}
+		m_size = (size_t)info.st_size;
+		if (m_size > 0) {
+			void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+			if (data == MAP_FAILED) {
+				::close(file);
+				m_size = 0;
+				printf("Failed to map file %s\n", filePath);
+				return false;
+			}
+			m_data = (const unsigned char*)data;
+		}
+		::close(file);
+#endif
+		m_open = true;
+		return true;
+	}
+	void MappedFile::close()
+	{
+		if (m_data != nullptr) {
+#ifdef _WIN32
+			UnmapViewOfFile(m_data);
+#else
+			munmap((void*)m_data, m_size);
+#endif
+		}
+		m_data = nullptr;
+		m_size = 0;
+		m_open = false;
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+
+namespace ew {
+	//Read only memory mapping of a whole file. Pages are loaded by the OS on first access.
+	//Move-only; the mapping is released with the object.
+	class MappedFile {
+	public:
+		MappedFile() {};
+		MappedFile(const char* filePath);
+		~MappedFile();
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		//Returns false if the file could not be opened or mapped. Empty files map to a null pointer
+		bool open(const char* filePath);
+		void close();
+
+		inline bool isOpen()const { return m_open; }
+		inline const unsigned char* getData()const { return m_data; }
+		inline size_t getSize()const { return m_size; }
+	private:
+		const unsigned char* m_data = nullptr;
+		size_t m_size = 0;
+		bool m_open = false;
+	};
+}
@@ -3,56 +3,303 @@
 */
 
 #include "mesh.h"
+#include <algorithm>
+#include <utility>
+#include <string.h>
 #include "ewMath/ewMath.h"
+#include "ewMath/transformations.h"
+#include "ewMath/batch.h"
+#include "ewMath/simd.h"
 #include "external/glad.h"
 
 namespace ew {
-	Mesh::Mesh(const MeshData& meshData)
+	/// <summary>
+	/// Box and sphere around a set of vertex positions. The sphere is centered on the box.
+	/// Positions are transposed 4 at a time so min/max and distances run 4 vertices per instruction.
+	/// </summary>
+	static Bounds calculateBounds(const Vertex* vertices, size_t count)
+	{
+		if (count == 0)
+			return Bounds();
+		ew::Vec3 min = vertices[0].pos;
+		ew::Vec3 max = vertices[0].pos;
+		size_t i = 0;
+#if defined(EW_SIMD_SSE)
+		//Loading pos reads 4 floats (pos + normal.x). The 4th lane is ignored after the transpose.
+		__m128 minX = _mm_set1_ps(min.x), minY = _mm_set1_ps(min.y), minZ = _mm_set1_ps(min.z);
+		__m128 maxX = minX, maxY = minY, maxZ = minZ;
+		for (; i + 4 <= count; i += 4) {
+			__m128 x = _mm_loadu_ps(&vertices[i].pos.x);
+			__m128 y = _mm_loadu_ps(&vertices[i + 1].pos.x);
+			__m128 z = _mm_loadu_ps(&vertices[i + 2].pos.x);
+			__m128 w = _mm_loadu_ps(&vertices[i + 3].pos.x);
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+			minX = _mm_min_ps(minX, x); maxX = _mm_max_ps(maxX, x);
+			minY = _mm_min_ps(minY, y); maxY = _mm_max_ps(maxY, y);
+			minZ = _mm_min_ps(minZ, z); maxZ = _mm_max_ps(maxZ, z);
+		}
+		alignas(16) float lanes[6][4];
+		_mm_store_ps(lanes[0], minX); _mm_store_ps(lanes[1], minY); _mm_store_ps(lanes[2], minZ);
+		_mm_store_ps(lanes[3], maxX); _mm_store_ps(lanes[4], maxY); _mm_store_ps(lanes[5], maxZ);
+		for (int l = 0; l < 4; l++) {
+			min = ew::Vec3(std::min(min.x, lanes[0][l]), std::min(min.y, lanes[1][l]), std::min(min.z, lanes[2][l]));
+			max = ew::Vec3(std::max(max.x, lanes[3][l]), std::max(max.y, lanes[4][l]), std::max(max.z, lanes[5][l]));
+		}
+#endif
+		for (; i < count; i++) {
+			const ew::Vec3& p = vertices[i].pos;
+			min = ew::Vec3(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+			max = ew::Vec3(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+		}
+
+		Bounds bounds(min, max);
+		//Tighten the sphere to the farthest vertex instead of the box corner
+		const ew::Vec3 c = bounds.center;
+		float maxDistSq = 0;
+		i = 0;
+#if defined(EW_SIMD_SSE)
+		const __m128 cx = _mm_set1_ps(c.x), cy = _mm_set1_ps(c.y), cz = _mm_set1_ps(c.z);
+		__m128 maxSq = _mm_setzero_ps();
+		for (; i + 4 <= count; i += 4) {
+			__m128 x = _mm_loadu_ps(&vertices[i].pos.x);
+			__m128 y = _mm_loadu_ps(&vertices[i + 1].pos.x);
+			__m128 z = _mm_loadu_ps(&vertices[i + 2].pos.x);
+			__m128 w = _mm_loadu_ps(&vertices[i + 3].pos.x);
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+			x = _mm_sub_ps(x, cx); y = _mm_sub_ps(y, cy); z = _mm_sub_ps(z, cz);
+			const __m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+			maxSq = _mm_max_ps(maxSq, distSq);
+		}
+		alignas(16) float sq[4];
+		_mm_store_ps(sq, maxSq);
+		maxDistSq = std::max(std::max(sq[0], sq[1]), std::max(sq[2], sq[3]));
+#endif
+		for (; i < count; i++) {
+			const ew::Vec3 d = vertices[i].pos - c;
+			maxDistSq = std::max(maxDistSq, ew::Dot(d, d));
+		}
+		bounds.radius = sqrtf(maxDistSq);
+		return bounds;
+	}
+
+	/// <summary>
+	/// Recalculates the bounding box and sphere of a mesh from its vertex positions.
+	/// Generators already fill in bounds, so this is only needed for meshes built or edited by hand.
+	/// </summary>
+	void computeBounds(MeshData& meshData)
+	{
+		meshData.bounds = calculateBounds(meshData.vertices.data(), meshData.vertices.size());
+	}
+
+	Mesh::Mesh(const MeshData& meshData, bool keepMeshData)
+	{
+		load(meshData, keepMeshData);
+	}
+	Mesh::Mesh(MeshData&& meshData, bool keepMeshData)
+	{
+		load(std::move(meshData), keepMeshData);
+	}
+	Mesh::Mesh(const QuantizedMeshData& meshData)
 	{
 		load(meshData);
 	}
-	void Mesh::load(const MeshData& meshData)
+	Mesh::~Mesh()
 	{
-		if (!m_initialized) {
-			glGenVertexArrays(1, &m_vao);
-			glBindVertexArray(m_vao);
+		destroy();
+	}
+	Mesh::Mesh(Mesh&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+	/// <summary>
+	/// Takes over other's GL objects and CPU copy. other is left empty, as if default constructed.
+	/// </summary>
+	Mesh& Mesh::operator=(Mesh&& other) noexcept
+	{
+		if (this == &other)
+			return *this;
+		destroy();
+		m_initialized = other.m_initialized;
+		m_vao = other.m_vao;
+		m_vbo = other.m_vbo;
+		m_ebo = other.m_ebo;
+		m_instanceBuffer = other.m_instanceBuffer;
+		m_indirectBuffer = other.m_indirectBuffer;
+		m_numVertices = other.m_numVertices;
+		m_numIndices = other.m_numIndices;
+		m_bounds = other.m_bounds;
+		m_quantized = other.m_quantized;
+		m_dequantizeMatrix = other.m_dequantizeMatrix;
+		m_meshData = std::move(other.m_meshData);
+		m_hasMeshData = other.m_hasMeshData;
 
-			glGenBuffers(1, &m_vbo);
-			glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		other.m_initialized = false;
+		other.m_vao = other.m_vbo = other.m_ebo = other.m_instanceBuffer = other.m_indirectBuffer = 0;
+		other.m_numVertices = other.m_numIndices = 0;
+		other.m_bounds = Bounds();
+		other.m_quantized = false;
+		other.m_dequantizeMatrix = ew::IdentityMatrix();
+		other.releaseMeshData();
+		return *this;
+	}
+	void Mesh::destroy()
+	{
+		if (!m_initialized)
+			return;
+		glDeleteBuffers(1, &m_vbo);
+		glDeleteBuffers(1, &m_ebo);
+		if (m_instanceBuffer != 0)
+			glDeleteBuffers(1, &m_instanceBuffer);
+		if (m_indirectBuffer != 0)
+			glDeleteBuffers(1, &m_indirectBuffer);
+		glDeleteVertexArrays(1, &m_vao);
+		m_vao = m_vbo = m_ebo = m_instanceBuffer = m_indirectBuffer = 0;
+		m_initialized = false;
+	}
+	/// <summary>
+	/// Uploads meshData. With keepMeshData it is also copied into the mesh, otherwise any previous copy is freed.
+	/// </summary>
+	void Mesh::load(const MeshData& meshData, bool keepMeshData)
+	{
+		upload(meshData);
+		if (!keepMeshData) {
+			releaseMeshData();
+		}
+		else if (&meshData != &m_meshData) {
+			m_meshData = meshData;
+			m_hasMeshData = true;
+		}
+	}
+	/// <summary>
+	/// Uploads meshData without copying it. With keepMeshData its arrays are moved into the mesh,
+	/// otherwise they are freed before returning. Either way meshData is left empty.
+	/// </summary>
+	void Mesh::load(MeshData&& meshData, bool keepMeshData)
+	{
+		upload(meshData);
+		if (keepMeshData) {
+			if (&meshData != &m_meshData) {
+				m_meshData = std::move(meshData);
+				m_hasMeshData = true;
+			}
+		}
+		else {
+			if (&meshData != &m_meshData) {
+				//The temporary frees the arrays when it goes out of scope
+				MeshData discarded = std::move(meshData);
+			}
+			releaseMeshData();
+		}
+	}
+	void Mesh::releaseMeshData()
+	{
+		//Swapping with empty vectors frees the memory, clear() would keep the capacity
+		MeshData().vertices.swap(m_meshData.vertices);
+		MeshData().indices.swap(m_meshData.indices);
+		m_meshData.bounds = Bounds();
+		m_hasMeshData = false;
+	}
+	void Mesh::upload(const MeshData& meshData)
+	{
+		upload(meshData.vertices.data(), meshData.vertices.size(), meshData.indices.data(), meshData.indices.size(), meshData.bounds);
+	}
+	void Mesh::upload(const Vertex* vertices, size_t numVertices, const unsigned int* indices, size_t numIndices, const Bounds& bounds)
+	{
+		prepareBuffers(false);
 
-			glGenBuffers(1, &m_ebo);
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
-			//Position attribute
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, pos));
-			glEnableVertexAttribArray(0);
+		if (numVertices > 0) {
+			glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * numVertices, vertices, GL_STATIC_DRAW);
+		}
+		if (numIndices > 0) {
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * numIndices, indices, GL_STATIC_DRAW);
+		}
+		m_numVertices = numVertices;
+		m_numIndices = numIndices;
+		m_bounds = bounds;
+		if (m_bounds.isEmpty() && m_numVertices > 0) {
+			m_bounds = calculateBounds(vertices, numVertices);
+		}
+		m_dequantizeMatrix = ew::IdentityMatrix();
 
-			//Normal attribute
-			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, normal));
-			glEnableVertexAttribArray(1);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+	/// <summary>
+	/// Uploads straight from caller owned memory (a mapped file, for example). Nothing is copied on the CPU and any kept MeshData is freed.
+	/// </summary>
+	void Mesh::load(const Vertex* vertices, size_t numVertices, const unsigned int* indices, size_t numIndices, const Bounds& bounds)
+	{
+		upload(vertices, numVertices, indices, numIndices, bounds);
+		releaseMeshData();
+	}
+	void Mesh::load(const QuantizedMeshData& meshData)
+	{
+		load(meshData.vertices.data(), meshData.vertices.size(), meshData.indices.data(), meshData.indices.size(), meshData.bounds);
+	}
+	void Mesh::load(const QuantizedVertex* vertices, size_t numVertices, const unsigned int* indices, size_t numIndices, const Bounds& bounds)
+	{
+		prepareBuffers(true);
 
-			//UV attribute
-			glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)(offsetof(Vertex, uv)));
-			glEnableVertexAttribArray(2);
+		if (numVertices > 0) {
+			glBufferData(GL_ARRAY_BUFFER, sizeof(QuantizedVertex) * numVertices, vertices, GL_STATIC_DRAW);
+		}
+		if (numIndices > 0) {
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * numIndices, indices, GL_STATIC_DRAW);
+		}
+		m_numVertices = numVertices;
+		m_numIndices = numIndices;
+		m_bounds = bounds;
+		//Normalized positions are in [0,1] across the box
+		m_dequantizeMatrix = ew::Translate(m_bounds.min) * ew::Scale(m_bounds.max - m_bounds.min);
 
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+	/// <summary>
+	/// Creates the VAO and buffers on first use and leaves them bound.
+	/// Vertex attributes are (re)specified when the vertex format changes.
+	/// </summary>
+	void Mesh::prepareBuffers(bool quantized)
+	{
+		const bool formatChanged = !m_initialized || quantized != m_quantized;
+		if (!m_initialized) {
+			glGenVertexArrays(1, &m_vao);
+			glGenBuffers(1, &m_vbo);
+			glGenBuffers(1, &m_ebo);
 			m_initialized = true;
 		}
-
 		glBindVertexArray(m_vao);
 		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
 
-		if (meshData.vertices.size() > 0) {
-			glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * meshData.vertices.size(), meshData.vertices.data(), GL_STATIC_DRAW);
+		if (formatChanged) {
+			setVertexAttributes(quantized);
+			m_quantized = quantized;
 		}
-		if (meshData.indices.size() > 0) {
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * meshData.indices.size(), meshData.indices.data(), GL_STATIC_DRAW);
+	}
+	void Mesh::setVertexAttributes(bool quantized)
+	{
+		if (quantized) {
+			//Position attribute
+			glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(QuantizedVertex), (const void*)offsetof(QuantizedVertex, pos));
+			//Normal attribute (octahedral, z is left at 0)
+			glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(QuantizedVertex), (const void*)offsetof(QuantizedVertex, normal));
+			//UV attribute
+			glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(QuantizedVertex), (const void*)offsetof(QuantizedVertex, uv));
 		}
-		m_numVertices = meshData.vertices.size();
-		m_numIndices = meshData.indices.size();
-
-		glBindVertexArray(0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		else {
+			//Position attribute
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, pos));
+			//Normal attribute
+			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, normal));
+			//UV attribute
+			glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)(offsetof(Vertex, uv)));
+		}
+		glEnableVertexAttribArray(0);
+		glEnableVertexAttribArray(1);
+		glEnableVertexAttribArray(2);
 	}
 	void Mesh::draw(ew::DrawMode drawMode) const
 	{
@@ -65,4 +312,185 @@ namespace ew {
 		}
 		
 	}
+	void Mesh::setInstances(const InstanceData* instances, size_t count)
+	{
+		if (!m_initialized)
+			return;
+		if (m_instanceBuffer == 0) {
+			glGenBuffers(1, &m_instanceBuffer);
+			glBindVertexArray(m_vao);
+			setInstanceAttributes(m_instanceBuffer);
+			glBindVertexArray(0);
+		}
+		//Orphan the old storage so updating every frame does not wait on previous draws
+		glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceData) * count, instances, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	void Mesh::drawInstanced(int count, ew::DrawMode drawMode) const
+	{
+		if (m_instanceBuffer == 0 || count <= 0)
+			return;
+		glBindVertexArray(m_vao);
+		if (drawMode == DrawMode::TRIANGLES) {
+			glDrawElementsInstanced(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, NULL, count);
+		}
+		else {
+			glDrawArraysInstanced(GL_POINTS, 0, m_numVertices, count);
+		}
+	}
+	void Mesh::drawIndirect(const DrawElementsIndirectCommand* commands, int count)
+	{
+		if (!m_initialized || count <= 0)
+			return;
+		if (m_indirectBuffer == 0)
+			glGenBuffers(1, &m_indirectBuffer);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand) * count, commands, GL_STREAM_DRAW);
+		glBindVertexArray(m_vao);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, NULL, count, 0);
+		glBindVertexArray(0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+	void setInstanceAttributes(unsigned int instanceBuffer)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+		//A mat4 attribute takes one location per column
+		for (int column = 0; column < 4; column++) {
+			glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (const void*)(offsetof(InstanceData, model) + sizeof(ew::Vec4) * column));
+			glVertexAttribPointer(7 + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (const void*)(offsetof(InstanceData, normalMatrix) + sizeof(ew::Vec4) * column));
+		}
+		glVertexAttribPointer(11, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (const void*)offsetof(InstanceData, color));
+		for (unsigned int location = 3; location <= 11; location++) {
+			glVertexAttribDivisor(location, 1);
+			glEnableVertexAttribArray(location);
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	/// <summary>
+	/// Float to IEEE half. Rounds to nearest, flushes values too small for a normal half to zero.
+	/// </summary>
+	static uint16_t floatToHalf(float f)
+	{
+		uint32_t bits;
+		memcpy(&bits, &f, sizeof(bits));
+		const uint32_t sign = (bits >> 16) & 0x8000;
+		const int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+		const uint32_t mantissa = bits & 0x7fffff;
+		if (exponent <= 0)
+			return (uint16_t)sign;
+		if (exponent >= 31)
+			return (uint16_t)(sign | 0x7c00);
+		uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+		//Round up on the highest dropped bit. A carry into the exponent is still correct
+		if (mantissa & 0x1000)
+			half++;
+		return (uint16_t)half;
+	}
+
+	static int16_t toSnorm16(float v)
+	{
+		return (int16_t)lroundf(ew::Clamp(v, -1.0f, 1.0f) * 32767.0f);
+	}
+
+	/// <summary>
+	/// Octahedral normal encoding: project onto the octahedron |x|+|y|+|z| = 1 and fold the lower half over the upper.
+	/// </summary>
+	static void encodeOctahedral(const ew::Vec3& normal, int16_t out[2])
+	{
+		const float l1 = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+		if (l1 == 0) {
+			out[0] = out[1] = 0;
+			return;
+		}
+		float x = normal.x / l1;
+		float y = normal.y / l1;
+		if (normal.z < 0) {
+			const float foldedX = (1.0f - fabsf(y)) * (x >= 0 ? 1.0f : -1.0f);
+			const float foldedY = (1.0f - fabsf(x)) * (y >= 0 ? 1.0f : -1.0f);
+			x = foldedX;
+			y = foldedY;
+		}
+		out[0] = toSnorm16(x);
+		out[1] = toSnorm16(y);
+	}
+
+	/// <summary>
+	/// Converts a mesh to QuantizedVertex format. Indices are copied unchanged.
+	/// Position error is at most half a step, (bounds size / 65535) / 2 per axis.
+	/// </summary>
+	/// <param name="meshData">Source mesh. Bounds are computed if it has none</param>
+	/// <returns></returns>
+	QuantizedMeshData quantizeMesh(const MeshData& meshData)
+	{
+		QuantizedMeshData quantized;
+		quantized.indices = meshData.indices;
+		quantized.bounds = meshData.bounds;
+		if (quantized.bounds.isEmpty())
+			quantized.bounds = calculateBounds(meshData.vertices.data(), meshData.vertices.size());
+
+		const ew::Vec3 min = quantized.bounds.min;
+		const ew::Vec3 size = quantized.bounds.max - min;
+		//Flat axes (e.g. a plane's y) quantize to 0
+		const ew::Vec3 invSize = ew::Vec3(
+			size.x > 0 ? 1.0f / size.x : 0.0f,
+			size.y > 0 ? 1.0f / size.y : 0.0f,
+			size.z > 0 ? 1.0f / size.z : 0.0f);
+
+		quantized.vertices.resize(meshData.vertices.size());
+		for (size_t i = 0; i < meshData.vertices.size(); i++) {
+			const Vertex& v = meshData.vertices[i];
+			QuantizedVertex& q = quantized.vertices[i];
+			q.pos[0] = (uint16_t)lroundf(ew::Clamp((v.pos.x - min.x) * invSize.x, 0.0f, 1.0f) * 65535.0f);
+			q.pos[1] = (uint16_t)lroundf(ew::Clamp((v.pos.y - min.y) * invSize.y, 0.0f, 1.0f) * 65535.0f);
+			q.pos[2] = (uint16_t)lroundf(ew::Clamp((v.pos.z - min.z) * invSize.z, 0.0f, 1.0f) * 65535.0f);
+			q.pos[3] = 0;
+			encodeOctahedral(v.normal, q.normal);
+			q.uv[0] = floatToHalf(v.uv.x);
+			q.uv[1] = floatToHalf(v.uv.y);
+		}
+		return quantized;
+	}
+
+	/// <summary>
+	/// Transforms a range of vertex positions and normals in place.
+	/// Vertices are gathered into small structure-of-arrays blocks so the SIMD batch kernels can be used.
+	/// </summary>
+	/// <param name="meshData">Mesh to modify</param>
+	/// <param name="model">Transform applied to positions</param>
+	/// <param name="normalMatrix">Transform applied to normals. Normals are renormalized afterwards.</param>
+	/// <param name="first">First vertex to transform</param>
+	/// <param name="count">Number of vertices. Clamped to the end of the vertex array</param>
+	void transformVertices(MeshData& meshData, const ew::Mat4& model, const ew::Mat4& normalMatrix, size_t first, size_t count)
+	{
+		const size_t numVertices = meshData.vertices.size();
+		if (first >= numVertices)
+			return;
+		count = std::min(count, numVertices - first);
+
+		const size_t BLOCK_SIZE = 256;
+		float x[BLOCK_SIZE], y[BLOCK_SIZE], z[BLOCK_SIZE];
+		Vertex* vertices = meshData.vertices.data() + first;
+		for (size_t start = 0; start < count; start += BLOCK_SIZE) {
+			const size_t n = std::min(BLOCK_SIZE, count - start);
+			Vertex* block = vertices + start;
+			//Positions
+			for (size_t i = 0; i < n; i++) {
+				x[i] = block[i].pos.x; y[i] = block[i].pos.y; z[i] = block[i].pos.z;
+			}
+			ew::TransformPoints(model, x, y, z, n);
+			for (size_t i = 0; i < n; i++) {
+				block[i].pos = ew::Vec3(x[i], y[i], z[i]);
+			}
+			//Normals
+			for (size_t i = 0; i < n; i++) {
+				x[i] = block[i].normal.x; y[i] = block[i].normal.y; z[i] = block[i].normal.z;
+			}
+			ew::TransformNormals(normalMatrix, x, y, z, n);
+			for (size_t i = 0; i < n; i++) {
+				block[i].normal = ew::Vec3(x[i], y[i], z[i]);
+			}
+		}
+		computeBounds(meshData);
+	}
 }
\ No newline at end of file
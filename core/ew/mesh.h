@@ -3,6 +3,9 @@
 */
 
 #pragma once
+#include <vector>
+#include <cstdint>
+#include <float.h>
 #include "ewMath/ewMath.h"
 
 namespace ew {
@@ -12,9 +15,74 @@ namespace ew {
 		ew::Vec2 uv;
 	};
 
+	//Axis aligned box (min, max) and bounding sphere (center, radius) in mesh space.
+	//Default constructed bounds are empty.
+	struct Bounds {
+		ew::Vec3 min = ew::Vec3(FLT_MAX);
+		ew::Vec3 max = ew::Vec3(-FLT_MAX);
+		ew::Vec3 center = ew::Vec3(0);
+		float radius = 0;
+
+		Bounds() = default;
+		//Sphere is centered on the box and encloses its corners
+		Bounds(const ew::Vec3& min, const ew::Vec3& max)
+			:min(min), max(max), center((min + max) * 0.5f), radius(ew::Magnitude(max - min) * 0.5f) {}
+
+		inline bool isEmpty()const { return min.x > max.x; }
+		//Half size of the box
+		inline ew::Vec3 extents()const { return (max - min) * 0.5f; }
+	};
+
 	struct MeshData {
 		std::vector<Vertex> vertices;
 		std::vector<unsigned int> indices;
+		Bounds bounds;
+	};
+
+	//Recalculates meshData.bounds from its vertex positions
+	void computeBounds(MeshData& meshData);
+
+	//16 byte vertex (half the size of Vertex). Uploaded as normalized integer / half float attributes:
+	//pos: unsigned normalized, relative to the mesh bounds. pos[3] is padding
+	//normal: signed normalized, octahedral encoded. Shaders decode it from vNormal.xy
+	//uv: half float
+	struct QuantizedVertex {
+		uint16_t pos[4];
+		int16_t normal[2];
+		uint16_t uv[2];
+	};
+
+	struct QuantizedMeshData {
+		std::vector<QuantizedVertex> vertices;
+		std::vector<unsigned int> indices;
+		Bounds bounds;
+	};
+
+	//Packs meshData into QuantizedVertex format. Positions are quantized within meshData.bounds
+	QuantizedMeshData quantizeMesh(const MeshData& meshData);
+
+	//Bakes a transform into vertices [first, first + count) of meshData using the batched ewMath kernels.
+	//normalMatrix should be the inverse transpose of model (or model itself if it has no non-uniform scale)
+	//Bounds are recomputed afterwards.
+	void transformVertices(MeshData& meshData, const ew::Mat4& model, const ew::Mat4& normalMatrix, size_t first = 0, size_t count = SIZE_MAX);
+
+	//Per instance data, read by shaders as instanced vertex attributes:
+	//model uses locations 3-6, normalMatrix 7-10, color 11
+	struct InstanceData {
+		ew::Mat4 model;
+		ew::Mat4 normalMatrix;
+		ew::Vec4 color = ew::Vec4(1.0f);
+	};
+	//Points attributes 3-11 of the bound VAO at an InstanceData buffer, advancing once per instance
+	void setInstanceAttributes(unsigned int instanceBuffer);
+
+	//Layout read by glMultiDrawElementsIndirect
+	struct DrawElementsIndirectCommand {
+		unsigned int count;
+		unsigned int instanceCount;
+		unsigned int firstIndex;
+		int baseVertex;
+		unsigned int baseInstance;
 	};
 
 	enum class DrawMode {
@@ -22,20 +90,68 @@ namespace ew {
 		POINTS = 1
 	};
 
+	//Owns a VAO and its buffers, which are deleted with the mesh. Move-only, so a Mesh can be returned
+	//and stored in containers without double deleting GL objects. Destroy meshes before the GL context.
+	//By default no CPU copy of the vertices is kept once they are uploaded. Pass keepMeshData = true
+	//to keep one (see getMeshData). Loading from an rvalue MeshData moves it in instead of copying, or
+	//frees it right after the upload when it is not kept.
 	class Mesh {
 	public:
 		Mesh() {};
-		Mesh(const MeshData& meshData);
-		void load(const MeshData& meshData);
+		Mesh(const MeshData& meshData, bool keepMeshData = false);
+		Mesh(MeshData&& meshData, bool keepMeshData = false);
+		Mesh(const QuantizedMeshData& meshData);
+		~Mesh();
+		Mesh(const Mesh&) = delete;
+		Mesh& operator=(const Mesh&) = delete;
+		Mesh(Mesh&& other) noexcept;
+		Mesh& operator=(Mesh&& other) noexcept;
+
+		void load(const MeshData& meshData, bool keepMeshData = false);
+		void load(MeshData&& meshData, bool keepMeshData = false);
+		//Quantized loads leave a kept MeshData untouched, so the mesh can be switched back with load(*getMeshData(), true)
+		void load(const QuantizedMeshData& meshData);
+		//Upload from arrays owned by the caller. Bounds are computed if empty (Vertex only)
+		void load(const Vertex* vertices, size_t numVertices, const unsigned int* indices, size_t numIndices, const Bounds& bounds);
+		void load(const QuantizedVertex* vertices, size_t numVertices, const unsigned int* indices, size_t numIndices, const Bounds& bounds);
 		void draw(DrawMode drawMode = DrawMode::TRIANGLES)const;
+		//Uploads per instance data for drawInstanced, replacing what was there
+		void setInstances(const InstanceData* instances, size_t count);
+		//Draws the first count instances from setInstances in one call
+		void drawInstanced(int count, DrawMode drawMode = DrawMode::TRIANGLES)const;
+		//Draws ranges of the index buffer with one glMultiDrawElementsIndirect call. Requires OpenGL 4.3
+		void drawIndirect(const DrawElementsIndirectCommand* commands, int count);
 		inline int getNumVertices()const { return m_numVertices; }
 		inline int getNumIndices()const { return m_numIndices; }
+		//Bounds of the last loaded MeshData, so culling never has to read vertices back
+		inline const Bounds& getBounds()const { return m_bounds; }
+		inline bool isQuantized()const { return m_quantized; }
+		//Maps vertex positions back into mesh space. Multiply it onto the right of the model matrix.
+		//Identity unless the mesh was loaded from QuantizedMeshData
+		inline const ew::Mat4& getDequantizeMatrix()const { return m_dequantizeMatrix; }
+		//CPU copy of the last loaded MeshData, or nullptr if it was not kept
+		inline const MeshData* getMeshData()const { return m_hasMeshData ? &m_meshData : nullptr; }
+		//Frees the CPU copy. GPU data is unaffected
+		void releaseMeshData();
 	private:
+		void upload(const MeshData& meshData);
+		void upload(const Vertex* vertices, size_t numVertices, const unsigned int* indices, size_t numIndices, const Bounds& bounds);
+		void prepareBuffers(bool quantized);
+		void setVertexAttributes(bool quantized);
+		void destroy();
+
 		bool m_initialized = false;
 		unsigned int m_vao = 0;
 		unsigned int m_vbo = 0;
 		unsigned int m_ebo = 0;
+		unsigned int m_instanceBuffer = 0;
+		unsigned int m_indirectBuffer = 0;
 		int m_numVertices = 0;
 		int m_numIndices = 0;
+		Bounds m_bounds;
+		bool m_quantized = false;
+		ew::Mat4 m_dequantizeMatrix = ew::IdentityMatrix();
+		MeshData m_meshData;
+		bool m_hasMeshData = false;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "meshCache.h"
+#include <stdio.h>
+#include "procGen.h"
+
+namespace ew {
+	static size_t meshBytes(const Mesh& mesh)
+	{
+		const size_t vertexSize = mesh.isQuantized() ? sizeof(QuantizedVertex) : sizeof(Vertex);
+		size_t bytes = (size_t)mesh.getNumVertices() * vertexSize + (size_t)mesh.getNumIndices() * sizeof(unsigned int);
+		if (const MeshData* meshData = mesh.getMeshData())
+			bytes += meshData->vertices.capacity() * sizeof(Vertex) + meshData->indices.capacity() * sizeof(unsigned int);
+		return bytes;
+	}
+
+	MeshCache::MeshCache(size_t memoryBudget) :m_memoryBudget(memoryBudget)
+	{
+	}
+	/// <summary>
+	/// A hit moves the entry to the front of the LRU list. A miss generates and uploads, then evicts
+	/// until the budget holds again (never the new mesh, which the caller is about to hold).
+	/// </summary>
+	/// <param name="key"></param>
+	/// <param name="generate">Only called on a miss</param>
+	/// <param name="keepMeshData">Passed to Mesh::load on a miss. Hits return the mesh as it was first loaded</param>
+	/// <returns></returns>
+	std::shared_ptr<Mesh> MeshCache::get(const std::string& key, const std::function<MeshData()>& generate, bool keepMeshData)
+	{
+		auto found = m_lookup.find(key);
+		if (found != m_lookup.end()) {
+			m_stats.hits++;
+			m_entries.splice(m_entries.begin(), m_entries, found->second);
+			return found->second->mesh;
+		}
+		m_stats.misses++;
+		std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>(generate(), keepMeshData);
+		const size_t bytes = meshBytes(*mesh);
+		m_entries.push_front({ key, mesh, bytes });
+		m_lookup[key] = m_entries.begin();
+		m_stats.numMeshes++;
+		m_stats.bytes += bytes;
+		evict(m_memoryBudget);
+		return mesh;
+	}
+	std::shared_ptr<Mesh> MeshCache::getCube(float size)
+	{
+		return get(makeKey("ew::cube", { size }), [=]() { return createCube(size); });
+	}
+	std::shared_ptr<Mesh> MeshCache::getPlane(float width, float height, int subdivisions)
+	{
+		return get(makeKey("ew::plane", { width, height, (float)subdivisions }), [=]() { return createPlane(width, height, subdivisions); });
+	}
+	std::shared_ptr<Mesh> MeshCache::getSphere(float radius, int subdivisions)
+	{
+		return get(makeKey("ew::sphere", { radius, (float)subdivisions }), [=]() { return createSphere(radius, subdivisions); });
+	}
+	std::shared_ptr<Mesh> MeshCache::getCylinder(float radius, float height, int subdivisions)
+	{
+		return get(makeKey("ew::cylinder", { radius, height, (float)subdivisions }), [=]() { return createCylinder(radius, height, subdivisions); });
+	}
+	void MeshCache::setMemoryBudget(size_t bytes)
+	{
+		m_memoryBudget = bytes;
+		evict(m_memoryBudget);
+	}
+	void MeshCache::clear()
+	{
+		evict(0);
+	}
+	/// <summary>
+	/// Walks from the least recently used end, skipping meshes that are held outside the cache.
+	/// </summary>
+	void MeshCache::evict(size_t budget)
+	{
+		auto it = m_entries.end();
+		while (m_stats.bytes > budget && it != m_entries.begin()) {
+			--it;
+			if (it->mesh.use_count() > 1)
+				continue;
+			m_stats.bytes -= it->bytes;
+			m_stats.numMeshes--;
+			m_stats.evictions++;
+			m_lookup.erase(it->key);
+			it = m_entries.erase(it);
+		}
+	}
+	std::string MeshCache::makeKey(const char* generator, std::initializer_list<float> params)
+	{
+		std::string key = generator;
+		key += '(';
+		char number[32];
+		for (const float* p = params.begin(); p != params.end(); p++) {
+			//9 significant digits round trip any float
+			snprintf(number, sizeof(number), p == params.begin() ? "%.9g" : ",%.9g", *p);
+			key += number;
+		}
+		key += ')';
+		return key;
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <functional>
+#include <initializer_list>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "mesh.h"
+
+namespace ew {
+	struct MeshCacheStats {
+		size_t hits = 0;
+		size_t misses = 0;
+		size_t evictions = 0;
+		size_t numMeshes = 0;
+		size_t bytes = 0; //GPU buffers plus kept MeshData of every cached mesh
+	};
+
+	//Shares generated meshes by key, so the same geometry is only generated and uploaded once.
+	//Keys name the generator and its parameters, e.g. makeKey("ew::sphere", { 0.5f, 64 }) = "ew::sphere(0.5,64)".
+	//Meshes are returned as shared_ptr and live as long as anyone holds them. When the cache is over its
+	//memory budget it drops the least recently used meshes that nobody else holds; meshes still in use are
+	//never dropped, so the budget can be exceeded while they are.
+	//Cached meshes are shared and must be treated as immutable: never load() into one. Its size is only
+	//measured when it is cached, and everyone else asking for the key would get the changed mesh.
+	//Not thread safe. Misses upload to OpenGL, so use it on the thread that owns the context.
+	class MeshCache {
+	public:
+		explicit MeshCache(size_t memoryBudget = 256 * 1024 * 1024);
+
+		//Returns the cached mesh for key, or uploads generate() and caches it
+		std::shared_ptr<Mesh> get(const std::string& key, const std::function<MeshData()>& generate, bool keepMeshData = false);
+		//ew::procGen shapes
+		std::shared_ptr<Mesh> getCube(float size);
+		std::shared_ptr<Mesh> getPlane(float width, float height, int subdivisions);
+		std::shared_ptr<Mesh> getSphere(float radius, int subdivisions);
+		std::shared_ptr<Mesh> getCylinder(float radius, float height, int subdivisions);
+
+		//Evicts down to the new budget right away
+		void setMemoryBudget(size_t bytes);
+		inline size_t getMemoryBudget()const { return m_memoryBudget; }
+		inline const MeshCacheStats& getStats()const { return m_stats; }
+		inline void resetCounters() { m_stats.hits = m_stats.misses = m_stats.evictions = 0; }
+		//Drops every mesh nobody else holds
+		void clear();
+
+		//"generator(p0,p1,...)". Floats are written with enough digits to tell any two apart
+		static std::string makeKey(const char* generator, std::initializer_list<float> params);
+	private:
+		struct Entry {
+			std::string key;
+			std::shared_ptr<Mesh> mesh;
+			size_t bytes;
+		};
+		void evict(size_t budget);
+
+		size_t m_memoryBudget;
+		MeshCacheStats m_stats;
+		//Most recently used at the front
+		std::list<Entry> m_entries;
+		std::unordered_map<std::string, std::list<Entry>::iterator> m_lookup;
+	};
+}
@@ -0,0 +1,152 @@
+#include "meshFile.h"
+#include <stdio.h>
+#include <string.h>
+
+namespace ew {
+	static_assert(sizeof(MeshFileHeader) == 88, "MeshFileHeader layout is part of the file format");
+	static_assert(sizeof(Vertex) == 32 && sizeof(QuantizedVertex) == 16, "Vertex layouts are part of the file format");
+
+	static uint64_t alignUp(uint64_t offset)
+	{
+		return (offset + MESH_FILE_ALIGNMENT - 1) / MESH_FILE_ALIGNMENT * MESH_FILE_ALIGNMENT;
+	}
+
+	/// <summary>
+	/// Writes the header followed by the two blobs, zero padding each blob up to the alignment.
+	/// </summary>
+	static bool writeMeshBlobs(const char* filePath, MeshFileFormat format, uint32_t vertexStride, const void* vertices, size_t numVertices,
+		const std::vector<unsigned int>& indices, const Bounds& bounds)
+	{
+		MeshFileHeader header = {};
+		header.magic = MESH_FILE_MAGIC;
+		header.version = MESH_FILE_VERSION;
+		header.format = format;
+		header.vertexStride = vertexStride;
+		header.numVertices = numVertices;
+		header.numIndices = indices.size();
+		header.vertexOffset = alignUp(sizeof(MeshFileHeader));
+		header.indexOffset = alignUp(header.vertexOffset + (uint64_t)vertexStride * numVertices);
+		memcpy(header.boundsMin, &bounds.min, sizeof(header.boundsMin));
+		memcpy(header.boundsMax, &bounds.max, sizeof(header.boundsMax));
+		memcpy(header.boundsCenter, &bounds.center, sizeof(header.boundsCenter));
+		header.boundsRadius = bounds.radius;
+
+		FILE* file = fopen(filePath, "wb");
+		if (file == NULL) {
+			printf("Failed to write mesh file %s\n", filePath);
+			return false;
+		}
+		static const unsigned char padding[MESH_FILE_ALIGNMENT] = {};
+		const uint64_t vertexBytes = (uint64_t)vertexStride * numVertices;
+		bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+		ok = ok && fwrite(padding, 1, header.vertexOffset - sizeof(header), file) == header.vertexOffset - sizeof(header);
+		ok = ok && (vertexBytes == 0 || fwrite(vertices, 1, vertexBytes, file) == vertexBytes);
+		const uint64_t vertexPadding = header.indexOffset - header.vertexOffset - vertexBytes;
+		ok = ok && fwrite(padding, 1, vertexPadding, file) == vertexPadding;
+		ok = ok && (indices.empty() || fwrite(indices.data(), sizeof(unsigned int), indices.size(), file) == indices.size());
+		ok = fclose(file) == 0 && ok;
+		if (!ok) {
+			printf("Failed to write mesh file %s\n", filePath);
+			remove(filePath);
+		}
+		return ok;
+	}
+	bool writeMeshFile(const char* filePath, const MeshData& meshData)
+	{
+		return writeMeshBlobs(filePath, MeshFileFormat::VERTEX, sizeof(Vertex), meshData.vertices.data(), meshData.vertices.size(), meshData.indices, meshData.bounds);
+	}
+	bool writeMeshFile(const char* filePath, const QuantizedMeshData& meshData)
+	{
+		return writeMeshBlobs(filePath, MeshFileFormat::QUANTIZED_VERTEX, sizeof(QuantizedVertex), meshData.vertices.data(), meshData.vertices.size(), meshData.indices, meshData.bounds);
+	}
+
+	MeshFile::MeshFile(const char* filePath)
+	{
+		open(filePath);
+	}
+	/// <summary>
+	/// Nothing but the header is read here. Blob pages are faulted in when they are first touched, normally by the upload.
+	/// </summary>
+	/// <param name="filePath"></param>
+	/// <returns></returns>
+	bool MeshFile::open(const char* filePath)
+	{
+		close();
+		if (!m_file.open(filePath))
+			return false;
+
+		const size_t size = m_file.getSize();
+		const unsigned char* data = m_file.getData();
+		if (size < sizeof(MeshFileHeader)) {
+			printf("%s is not a mesh file\n", filePath);
+			close();
+			return false;
+		}
+		memcpy(&m_header, data, sizeof(MeshFileHeader));
+		if (m_header.magic != MESH_FILE_MAGIC) {
+			printf("%s is not a mesh file\n", filePath);
+			close();
+			return false;
+		}
+		if (m_header.version != MESH_FILE_VERSION) {
+			printf("%s has mesh file version %u, expected %u\n", filePath, m_header.version, MESH_FILE_VERSION);
+			close();
+			return false;
+		}
+		const bool quantized = m_header.format == MeshFileFormat::QUANTIZED_VERTEX;
+		const uint32_t stride = quantized ? sizeof(QuantizedVertex) : sizeof(Vertex);
+		const bool formatValid = (quantized || m_header.format == MeshFileFormat::VERTEX) && m_header.vertexStride == stride;
+		//Overflow safe range checks
+		const bool verticesFit = m_header.vertexOffset <= size && m_header.numVertices <= (size - m_header.vertexOffset) / stride;
+		const bool indicesFit = m_header.indexOffset <= size && m_header.numIndices <= (size - m_header.indexOffset) / sizeof(unsigned int);
+		const bool aligned = m_header.vertexOffset % alignof(Vertex) == 0 && m_header.indexOffset % alignof(unsigned int) == 0;
+		if (!formatValid || !verticesFit || !indicesFit || !aligned) {
+			printf("%s is corrupt\n", filePath);
+			close();
+			return false;
+		}
+
+		m_vertices = data + m_header.vertexOffset;
+		m_indices = (const unsigned int*)(data + m_header.indexOffset);
+		memcpy(&m_bounds.min, m_header.boundsMin, sizeof(m_header.boundsMin));
+		memcpy(&m_bounds.max, m_header.boundsMax, sizeof(m_header.boundsMax));
+		memcpy(&m_bounds.center, m_header.boundsCenter, sizeof(m_header.boundsCenter));
+		m_bounds.radius = m_header.boundsRadius;
+		return true;
+	}
+	void MeshFile::close()
+	{
+		m_file.close();
+		m_header = {};
+		m_bounds = Bounds();
+		m_vertices = nullptr;
+		m_indices = nullptr;
+	}
+	void MeshFile::upload(Mesh& mesh)const
+	{
+		if (!isOpen())
+			return;
+		if (isQuantized())
+			mesh.load(getQuantizedVertices(), getNumVertices(), m_indices, getNumIndices(), m_bounds);
+		else
+			mesh.load(getVertices(), getNumVertices(), m_indices, getNumIndices(), m_bounds);
+	}
+	MeshData MeshFile::toMeshData()const
+	{
+		MeshData meshData;
+		if (!isOpen() || isQuantized())
+			return meshData;
+		meshData.vertices.assign(getVertices(), getVertices() + getNumVertices());
+		meshData.indices.assign(m_indices, m_indices + getNumIndices());
+		//open() only checks ranges. CPU consumers index vertices[indices[i]] unchecked, so reject bad index values here
+		const size_t numVertices = getNumVertices();
+		for (size_t i = 0; i < meshData.indices.size(); i++) {
+			if (meshData.indices[i] >= numVertices) {
+				printf("Mesh file index %u out of range (%zu vertices)\n", meshData.indices[i], numVertices);
+				return MeshData();
+			}
+		}
+		meshData.bounds = m_bounds;
+		return meshData;
+	}
+}
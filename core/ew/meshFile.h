@@ -0,0 +1,70 @@
+#pragma once
+#include <stdint.h>
+#include "mesh.h"
+#include "mappedFile.h"
+
+//Binary container for generated or imported meshes, so they can be loaded without regenerating or parsing.
+//Layout (little endian): MeshFileHeader, then the vertex blob and the index blob, each starting on a
+//MESH_FILE_ALIGNMENT boundary. Blobs hold Vertex/QuantizedVertex and 32 bit indices exactly as ew::Mesh
+//uploads them, so a mapped file can be handed to glBufferData as is.
+namespace ew {
+	const uint32_t MESH_FILE_MAGIC = 0x48534d45; //"EMSH"
+	const uint32_t MESH_FILE_VERSION = 1;
+	const uint32_t MESH_FILE_ALIGNMENT = 64;
+
+	enum class MeshFileFormat : uint32_t {
+		VERTEX = 0,          //ew::Vertex
+		QUANTIZED_VERTEX = 1 //ew::QuantizedVertex
+	};
+
+	struct MeshFileHeader {
+		uint32_t magic;
+		uint32_t version;
+		MeshFileFormat format;
+		uint32_t vertexStride; //sizeof the vertex type, checked on load
+		uint64_t numVertices;
+		uint64_t numIndices;
+		uint64_t vertexOffset; //From the start of the file
+		uint64_t indexOffset;
+		float boundsMin[3];
+		float boundsMax[3];
+		float boundsCenter[3];
+		float boundsRadius;
+	};
+
+	//Returns false if the file could not be written
+	bool writeMeshFile(const char* filePath, const MeshData& meshData);
+	bool writeMeshFile(const char* filePath, const QuantizedMeshData& meshData);
+
+	//Memory mapped mesh file. Vertex and index pointers point into the mapping and stay valid while it is open.
+	class MeshFile {
+	public:
+		MeshFile() {};
+		MeshFile(const char* filePath);
+
+		//Maps the file and validates the header, format and blob ranges. Index values are not checked.
+		//Returns false (and stays closed) if anything is wrong
+		bool open(const char* filePath);
+		void close();
+		//Uploads the mapped blobs directly. Nothing is copied on the CPU and index values are not checked
+		void upload(Mesh& mesh)const;
+		//Copies the contents into MeshData. Returns empty MeshData for quantized files or if any index is >= getNumVertices()
+		MeshData toMeshData()const;
+
+		inline bool isOpen()const { return m_file.isOpen(); }
+		inline bool isQuantized()const { return m_header.format == MeshFileFormat::QUANTIZED_VERTEX; }
+		inline size_t getNumVertices()const { return (size_t)m_header.numVertices; }
+		inline size_t getNumIndices()const { return (size_t)m_header.numIndices; }
+		inline const Bounds& getBounds()const { return m_bounds; }
+		//Null unless the file holds that vertex type
+		inline const Vertex* getVertices()const { return isOpen() && !isQuantized() ? (const Vertex*)m_vertices : nullptr; }
+		inline const QuantizedVertex* getQuantizedVertices()const { return isOpen() && isQuantized() ? (const QuantizedVertex*)m_vertices : nullptr; }
+		inline const unsigned int* getIndices()const { return m_indices; }
+	private:
+		MappedFile m_file;
+		MeshFileHeader m_header = {};
+		Bounds m_bounds;
+		const void* m_vertices = nullptr;
+		const unsigned int* m_indices = nullptr;
+	};
+}
@@ -0,0 +1,768 @@
+#include "meshLoader.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <cmath>
+#include <algorithm>
+#include <charconv>
+#include <string>
+#include <vector>
+#include "mappedFile.h"
+#include "threadPool.h"
+#include "ewMath/quat.h"
+
+namespace ew {
+	/// <summary>
+	/// Area weighted average of face normals, for vertices that came without one.
+	/// </summary>
+	/// <param name="firstIndex">Only triangles from here on contribute</param>
+	/// <param name="missing">Per vertex flag. Null means every vertex from firstVertex on</param>
+	static void generateNormals(MeshData& meshData, size_t firstVertex, size_t firstIndex, const unsigned char* missing)
+	{
+		std::vector<Vertex>& vertices = meshData.vertices;
+		auto isMissing = [&](unsigned int v) { return missing ? missing[v] != 0 : v >= firstVertex; };
+		for (size_t v = firstVertex; v < vertices.size(); v++) {
+			if (isMissing((unsigned int)v))
+				vertices[v].normal = ew::Vec3(0);
+		}
+		for (size_t i = firstIndex; i + 2 < meshData.indices.size(); i += 3) {
+			const unsigned int a = meshData.indices[i], b = meshData.indices[i + 1], c = meshData.indices[i + 2];
+			//Cross product length is twice the area, so larger faces weigh more
+			const ew::Vec3 n = ew::Cross(vertices[b].pos - vertices[a].pos, vertices[c].pos - vertices[a].pos);
+			if (isMissing(a)) vertices[a].normal += n;
+			if (isMissing(b)) vertices[b].normal += n;
+			if (isMissing(c)) vertices[c].normal += n;
+		}
+		for (size_t v = firstVertex; v < vertices.size(); v++) {
+			if (!isMissing((unsigned int)v))
+				continue;
+			const float length = ew::Magnitude(vertices[v].normal);
+			vertices[v].normal = length > 0 ? vertices[v].normal / length : ew::Vec3(0, 1, 0);
+		}
+	}
+
+	namespace {
+		//OBJ
+
+		inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+		inline const char* skipBlanks(const char* p, const char* end) {
+			while (p < end && isBlank(*p))
+				p++;
+			return p;
+		}
+		inline const char* skipLine(const char* p, const char* end) {
+			const char* newline = (const char*)memchr(p, '\n', end - p);
+			return newline ? newline + 1 : end;
+		}
+		//from_chars does not skip whitespace or accept a leading '+'. Bad input reads as 0 and skips the token
+		inline const char* parseFloat(const char* p, const char* end, float& value) {
+			p = skipBlanks(p, end);
+			if (p < end && *p == '+')
+				p++;
+			const std::from_chars_result result = std::from_chars(p, end, value);
+			if (result.ec == std::errc())
+				return result.ptr;
+			value = 0;
+			while (p < end && !isBlank(*p) && *p != '\n')
+				p++;
+			return p;
+		}
+		inline const char* parseInt(const char* p, const char* end, int64_t& value, bool& ok) {
+			if (p < end && *p == '+')
+				p++;
+			const std::from_chars_result result = std::from_chars(p, end, value);
+			ok = result.ec == std::errc();
+			return ok ? result.ptr : p;
+		}
+
+		//Face corner before vertices are merged. Indices are 0 based and absolute, NO_INDEX when absent.
+		//Negative OBJ indices count back from the current element; they are stored relative to the chunk
+		//(chunkIndex - RELATIVE) and resolved once the counts of earlier chunks are known.
+		const int64_t NO_INDEX = -1;
+		const int64_t RELATIVE = (int64_t)1 << 40;
+		struct ObjCorner {
+			int64_t position;
+			int64_t uv;
+			int64_t normal;
+		};
+		struct ObjChunk {
+			std::vector<ew::Vec3> positions;
+			std::vector<ew::Vec2> uvs;
+			std::vector<ew::Vec3> normals;
+			std::vector<ObjCorner> corners; //3 per triangle
+			bool error = false;
+		};
+
+		inline int64_t toIndex(int64_t objIndex, size_t localCount) {
+			if (objIndex > 0)
+				return objIndex - 1;
+			if (objIndex < 0)
+				return (int64_t)localCount + objIndex - RELATIVE;
+			return NO_INDEX;
+		}
+		inline int64_t resolveIndex(int64_t index, size_t base) {
+			return index < NO_INDEX ? index + RELATIVE + (int64_t)base : index;
+		}
+
+		void parseObjChunk(const char* p, const char* end, ObjChunk& chunk)
+		{
+			ObjCorner polygon[3];
+			while (p < end) {
+				p = skipBlanks(p, end);
+				if (p + 1 >= end || *p == '\n' || *p == '#') {
+					p = skipLine(p, end);
+					continue;
+				}
+				if (p[0] == 'v' && isBlank(p[1])) {
+					ew::Vec3 v;
+					p = parseFloat(p + 1, end, v.x);
+					p = parseFloat(p, end, v.y);
+					p = parseFloat(p, end, v.z);
+					chunk.positions.push_back(v);
+				}
+				else if (p[0] == 'v' && p[1] == 't' && p + 2 < end && isBlank(p[2])) {
+					ew::Vec2 uv;
+					p = parseFloat(p + 2, end, uv.x);
+					p = parseFloat(p, end, uv.y);
+					chunk.uvs.push_back(uv);
+				}
+				else if (p[0] == 'v' && p[1] == 'n' && p + 2 < end && isBlank(p[2])) {
+					ew::Vec3 n;
+					p = parseFloat(p + 2, end, n.x);
+					p = parseFloat(p, end, n.y);
+					p = parseFloat(p, end, n.z);
+					chunk.normals.push_back(n);
+				}
+				else if (p[0] == 'f' && isBlank(p[1])) {
+					//p, p/t, p//n or p/t/n per corner. Polygons become a fan around the first corner
+					p++;
+					int numCorners = 0;
+					while (true) {
+						p = skipBlanks(p, end);
+						if (p >= end || *p == '\n')
+							break;
+						ObjCorner corner = { NO_INDEX, NO_INDEX, NO_INDEX };
+						int64_t value;
+						bool ok;
+						p = parseInt(p, end, value, ok);
+						if (!ok) {
+							chunk.error = true;
+							return;
+						}
+						corner.position = toIndex(value, chunk.positions.size());
+						if (p < end && *p == '/') {
+							p++;
+							if (p < end && *p != '/') {
+								p = parseInt(p, end, value, ok);
+								if (ok)
+									corner.uv = toIndex(value, chunk.uvs.size());
+							}
+							if (p < end && *p == '/') {
+								p = parseInt(p + 1, end, value, ok);
+								if (ok)
+									corner.normal = toIndex(value, chunk.normals.size());
+							}
+						}
+						if (numCorners < 2) {
+							polygon[numCorners] = corner;
+						}
+						else {
+							chunk.corners.push_back(polygon[0]);
+							chunk.corners.push_back(polygon[1]);
+							chunk.corners.push_back(corner);
+							polygon[1] = corner;
+						}
+						numCorners++;
+					}
+				}
+				p = skipLine(p, end);
+			}
+		}
+
+		inline uint64_t hashCorner(const ObjCorner& c) {
+			uint64_t h = (uint64_t)c.position * 0x9e3779b97f4a7c15ull;
+			h ^= ((uint64_t)c.uv + 0x632be59bd9b4e019ull) * 0xbf58476d1ce4e5b9ull;
+			h ^= ((uint64_t)c.normal + 0x8cb92ba72f3d8dd7ull) * 0x94d049bb133111ebull;
+			return h ^ (h >> 29);
+		}
+	}
+
+	/// <summary>
+	/// 1. Split the mapped file into one chunk per thread, each starting after a newline.
+	/// 2. Parse chunks in parallel into positions, uvs, normals and triangulated corners.
+	/// 3. Offset each chunk's elements by the counts of the chunks before it.
+	/// 4. Merge identical corners into vertices with a hash table.
+	/// </summary>
+	/// <param name="filePath"></param>
+	/// <param name="numThreads">Number of chunks, parsed on ThreadPool::getShared(). 0 = one per pool thread</param>
+	/// <returns></returns>
+	MeshData loadOBJ(const char* filePath, unsigned int numThreads)
+	{
+		MeshData meshData;
+		MappedFile file;
+		if (!file.open(filePath))
+			return meshData;
+		const char* begin = (const char*)file.getData();
+		const char* end = begin + file.getSize();
+		ThreadPool& pool = ThreadPool::getShared();
+		if (numThreads == 0)
+			numThreads = pool.getNumThreads();
+		//Small files are not worth a thread each
+		const size_t MIN_CHUNK_SIZE = 1 << 20;
+		numThreads = (unsigned int)std::min<size_t>(numThreads, file.getSize() / MIN_CHUNK_SIZE + 1);
+
+		std::vector<const char*> starts(numThreads + 1);
+		starts[0] = begin;
+		starts[numThreads] = end;
+		for (unsigned int t = 1; t < numThreads; t++) {
+			const char* split = begin + file.getSize() * t / numThreads;
+			starts[t] = std::max(starts[t - 1], split > begin && split[-1] == '\n' ? split : skipLine(split, end));
+		}
+		std::vector<ObjChunk> chunks(numThreads);
+		pool.parallelFor(numThreads, 1, [&](size_t first, size_t last) {
+			for (size_t t = first; t < last; t++)
+				parseObjChunk(starts[t], starts[t + 1], chunks[t]);
+		});
+
+		//Concatenate elements and resolve indices
+		size_t numPositions = 0, numUVs = 0, numNormals = 0, numCorners = 0;
+		for (const ObjChunk& chunk : chunks) {
+			if (chunk.error) {
+				printf("Failed to parse %s: malformed face\n", filePath);
+				return meshData;
+			}
+			numPositions += chunk.positions.size();
+			numUVs += chunk.uvs.size();
+			numNormals += chunk.normals.size();
+			numCorners += chunk.corners.size();
+		}
+		std::vector<ew::Vec3> positions, normals;
+		std::vector<ew::Vec2> uvs;
+		std::vector<ObjCorner> corners;
+		positions.reserve(numPositions);
+		uvs.reserve(numUVs);
+		normals.reserve(numNormals);
+		corners.reserve(numCorners);
+		for (ObjChunk& chunk : chunks) {
+			const size_t positionBase = positions.size(), uvBase = uvs.size(), normalBase = normals.size();
+			for (ObjCorner corner : chunk.corners) {
+				corner.position = resolveIndex(corner.position, positionBase);
+				corner.uv = resolveIndex(corner.uv, uvBase);
+				corner.normal = resolveIndex(corner.normal, normalBase);
+				const bool valid = corner.position >= 0 && corner.position < (int64_t)numPositions
+					&& corner.uv < (int64_t)numUVs && corner.normal < (int64_t)numNormals && corner.uv >= NO_INDEX && corner.normal >= NO_INDEX;
+				if (!valid) {
+					printf("Failed to parse %s: face index out of range\n", filePath);
+					return meshData;
+				}
+				corners.push_back(corner);
+			}
+			positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+			uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+			normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+			chunk = ObjChunk();
+		}
+
+		//Open addressing table from corner to vertex index + 1 (0 = empty)
+		size_t capacity = 16;
+		while (capacity < numCorners * 2)
+			capacity *= 2;
+		std::vector<unsigned int> table(capacity, 0);
+		std::vector<ObjCorner> vertexCorners;
+		std::vector<unsigned char> missingNormals;
+		bool anyMissingNormals = false;
+		meshData.indices.resize(numCorners);
+		for (size_t i = 0; i < numCorners; i++) {
+			const ObjCorner& corner = corners[i];
+			size_t slot = hashCorner(corner) & (capacity - 1);
+			while (table[slot] != 0) {
+				const ObjCorner& other = vertexCorners[table[slot] - 1];
+				if (other.position == corner.position && other.uv == corner.uv && other.normal == corner.normal)
+					break;
+				slot = (slot + 1) & (capacity - 1);
+			}
+			if (table[slot] == 0) {
+				Vertex vertex;
+				vertex.pos = positions[corner.position];
+				vertex.uv = corner.uv >= 0 ? uvs[corner.uv] : ew::Vec2(0);
+				vertex.normal = corner.normal >= 0 ? normals[corner.normal] : ew::Vec3(0);
+				meshData.vertices.push_back(vertex);
+				vertexCorners.push_back(corner);
+				missingNormals.push_back(corner.normal < 0);
+				anyMissingNormals |= corner.normal < 0;
+				table[slot] = (unsigned int)meshData.vertices.size();
+			}
+			meshData.indices[i] = table[slot] - 1;
+		}
+		if (anyMissingNormals)
+			generateNormals(meshData, 0, 0, missingNormals.data());
+		computeBounds(meshData);
+		return meshData;
+	}
+
+	namespace {
+		//glTF
+
+		//Just enough JSON for glTF: a DOM of nested values, no streaming
+		struct JsonValue {
+			enum Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+			Type type = NUL;
+			bool boolean = false;
+			double number = 0;
+			std::string string;
+			std::vector<JsonValue> array;
+			std::vector<std::pair<std::string, JsonValue>> object;
+
+			const JsonValue* find(const char* key)const {
+				for (const auto& member : object) {
+					if (member.first == key)
+						return &member.second;
+				}
+				return nullptr;
+			}
+			double getNumber(const char* key, double fallback)const {
+				const JsonValue* value = find(key);
+				return value && value->type == NUMBER ? value->number : fallback;
+			}
+			//-1 unless this is a number that fits an int index
+			int asIndex()const {
+				return type == NUMBER && number >= 0 && number < 2147483647.0 ? (int)number : -1;
+			}
+			int getInt(const char* key, int fallback)const {
+				const JsonValue* value = find(key);
+				return value && value->type == NUMBER && fabs(value->number) < 2147483647.0 ? (int)value->number : fallback;
+			}
+			const JsonValue* at(size_t i)const {
+				return type == ARRAY && i < array.size() ? &array[i] : nullptr;
+			}
+			const JsonValue* at(const char* key, int i)const {
+				const JsonValue* value = find(key);
+				return value && i >= 0 ? value->at((size_t)i) : nullptr;
+			}
+		};
+
+		class JsonParser {
+		public:
+			JsonParser(const char* begin, const char* end) :m_p(begin), m_end(end) {}
+			bool parse(JsonValue& value) {
+				return parseValue(value, 0) && (skipSpace(), m_p == m_end);
+			}
+		private:
+			const char* m_p;
+			const char* m_end;
+
+			void skipSpace() {
+				while (m_p < m_end && (*m_p == ' ' || *m_p == '\t' || *m_p == '\n' || *m_p == '\r' || *m_p == '\0'))
+					m_p++;
+			}
+			bool consume(const char* literal) {
+				const size_t length = strlen(literal);
+				if ((size_t)(m_end - m_p) < length || memcmp(m_p, literal, length) != 0)
+					return false;
+				m_p += length;
+				return true;
+			}
+			bool parseValue(JsonValue& value, int depth) {
+				if (depth > 64)
+					return false;
+				skipSpace();
+				if (m_p >= m_end)
+					return false;
+				switch (*m_p) {
+				case '{': {
+					value.type = JsonValue::OBJECT;
+					m_p++;
+					skipSpace();
+					if (m_p < m_end && *m_p == '}') {
+						m_p++;
+						return true;
+					}
+					while (true) {
+						skipSpace();
+						std::pair<std::string, JsonValue> member;
+						if (!parseString(member.first))
+							return false;
+						skipSpace();
+						if (!consume(":") || !parseValue(member.second, depth + 1))
+							return false;
+						value.object.push_back(std::move(member));
+						skipSpace();
+						if (consume(","))
+							continue;
+						return consume("}");
+					}
+				}
+				case '[': {
+					value.type = JsonValue::ARRAY;
+					m_p++;
+					skipSpace();
+					if (m_p < m_end && *m_p == ']') {
+						m_p++;
+						return true;
+					}
+					while (true) {
+						value.array.emplace_back();
+						if (!parseValue(value.array.back(), depth + 1))
+							return false;
+						skipSpace();
+						if (consume(","))
+							continue;
+						return consume("]");
+					}
+				}
+				case '"':
+					value.type = JsonValue::STRING;
+					return parseString(value.string);
+				case 't':
+					value.type = JsonValue::BOOLEAN;
+					value.boolean = true;
+					return consume("true");
+				case 'f':
+					value.type = JsonValue::BOOLEAN;
+					return consume("false");
+				case 'n':
+					return consume("null");
+				default: {
+					value.type = JsonValue::NUMBER;
+					const std::from_chars_result result = std::from_chars(m_p, m_end, value.number);
+					//from_chars also accepts inf and nan, which JSON does not
+					if (result.ec != std::errc() || !std::isfinite(value.number))
+						return false;
+					m_p = result.ptr;
+					return true;
+				}
+				}
+			}
+			bool parseString(std::string& out) {
+				if (!consume("\""))
+					return false;
+				while (m_p < m_end && *m_p != '"') {
+					if (*m_p != '\\') {
+						out += *m_p++;
+						continue;
+					}
+					if (++m_p >= m_end)
+						return false;
+					const char escaped = *m_p++;
+					switch (escaped) {
+					case 'n': out += '\n'; break;
+					case 't': out += '\t'; break;
+					case 'r': out += '\r'; break;
+					case 'b': out += '\b'; break;
+					case 'f': out += '\f'; break;
+					case 'u': {
+						//Basic plane only, encoded as UTF-8. glTF keys are ASCII, so this only matters for names
+						unsigned int code = 0;
+						if (m_end - m_p < 4 || std::from_chars(m_p, m_p + 4, code, 16).ptr != m_p + 4)
+							return false;
+						m_p += 4;
+						if (code < 0x80) {
+							out += (char)code;
+						}
+						else if (code < 0x800) {
+							out += (char)(0xc0 | (code >> 6));
+							out += (char)(0x80 | (code & 0x3f));
+						}
+						else {
+							out += (char)(0xe0 | (code >> 12));
+							out += (char)(0x80 | ((code >> 6) & 0x3f));
+							out += (char)(0x80 | (code & 0x3f));
+						}
+						break;
+					}
+					default: out += escaped; break;
+					}
+				}
+				return consume("\"");
+			}
+		};
+
+		const uint32_t GLB_MAGIC = 0x46546c67; //"glTF"
+		const uint32_t GLB_CHUNK_JSON = 0x4e4f534a;
+		const uint32_t GLB_CHUNK_BIN = 0x004e4942;
+		enum ComponentType {
+			COMPONENT_BYTE = 5120, COMPONENT_UNSIGNED_BYTE = 5121, COMPONENT_SHORT = 5122,
+			COMPONENT_UNSIGNED_SHORT = 5123, COMPONENT_UNSIGNED_INT = 5125, COMPONENT_FLOAT = 5126
+		};
+
+		//Strided view of an accessor inside the BIN chunk
+		struct Accessor {
+			const unsigned char* data = nullptr;
+			size_t count = 0;
+			size_t stride = 0;
+			int componentType = 0;
+			int numComponents = 0;
+			bool normalized = false;
+		};
+
+		int componentSize(int componentType) {
+			switch (componentType) {
+			case COMPONENT_BYTE: case COMPONENT_UNSIGNED_BYTE: return 1;
+			case COMPONENT_SHORT: case COMPONENT_UNSIGNED_SHORT: return 2;
+			case COMPONENT_UNSIGNED_INT: case COMPONENT_FLOAT: return 4;
+			default: return 0;
+			}
+		}
+		int typeComponents(const std::string& type) {
+			if (type == "SCALAR") return 1;
+			if (type == "VEC2") return 2;
+			if (type == "VEC3") return 3;
+			if (type == "VEC4") return 4;
+			if (type == "MAT4") return 16;
+			return 0;
+		}
+
+		struct GlbDocument {
+			JsonValue json;
+			const unsigned char* bin = nullptr;
+			size_t binSize = 0;
+
+			//Validates that every element of the accessor lies inside its buffer view and the BIN chunk
+			bool getAccessor(int index, Accessor& accessor)const {
+				const JsonValue* a = json.at("accessors", index);
+				if (!a || a->find("sparse"))
+					return false;
+				const JsonValue* type = a->find("type");
+				accessor.componentType = a->getInt("componentType", 0);
+				accessor.numComponents = type && type->type == JsonValue::STRING ? typeComponents(type->string) : 0;
+				accessor.normalized = a->find("normalized") && a->find("normalized")->boolean;
+				const double count = a->getNumber("count", -1);
+				const size_t elementSize = (size_t)componentSize(accessor.componentType) * accessor.numComponents;
+				if (elementSize == 0 || count < 0 || count > (double)binSize)
+					return false;
+				accessor.count = (size_t)count;
+
+				const JsonValue* view = json.at("bufferViews", a->getInt("bufferView", -1));
+				if (!view || view->getInt("buffer", -1) != 0)
+					return false;
+				const double viewOffset = view->getNumber("byteOffset", 0);
+				const double viewLength = view->getNumber("byteLength", -1);
+				const double accessorOffset = a->getNumber("byteOffset", 0);
+				const double stride = view->getNumber("byteStride", 0);
+				if (stride < 0 || stride > 252)
+					return false;
+				accessor.stride = (size_t)stride;
+				if (accessor.stride == 0)
+					accessor.stride = elementSize;
+				if (viewOffset < 0 || viewLength < 0 || accessorOffset < 0 || viewOffset + viewLength > (double)binSize || accessor.stride < elementSize)
+					return false;
+				if (accessor.count > 0 && accessorOffset + (double)accessor.stride * (accessor.count - 1) + elementSize > viewLength)
+					return false;
+				accessor.data = bin + (size_t)viewOffset + (size_t)accessorOffset;
+				return true;
+			}
+		};
+
+		//Component i of element e, converted to float (normalized integers map to [0,1] or [-1,1])
+		inline float readFloat(const Accessor& accessor, size_t e, int i) {
+			const unsigned char* p = accessor.data + accessor.stride * e + (size_t)componentSize(accessor.componentType) * i;
+			switch (accessor.componentType) {
+			case COMPONENT_FLOAT: { float f; memcpy(&f, p, 4); return f; }
+			case COMPONENT_UNSIGNED_BYTE: return accessor.normalized ? *p / 255.0f : *p;
+			case COMPONENT_BYTE: return accessor.normalized ? fmaxf((int8_t)*p / 127.0f, -1.0f) : (int8_t)*p;
+			case COMPONENT_UNSIGNED_SHORT: { uint16_t v; memcpy(&v, p, 2); return accessor.normalized ? v / 65535.0f : v; }
+			case COMPONENT_SHORT: { int16_t v; memcpy(&v, p, 2); return accessor.normalized ? fmaxf(v / 32767.0f, -1.0f) : v; }
+			case COMPONENT_UNSIGNED_INT: { uint32_t v; memcpy(&v, p, 4); return (float)v; }
+			default: return 0.0f;
+			}
+		}
+		//glTF only allows unsigned integer indices
+		bool isIndexType(int componentType) {
+			return componentType == COMPONENT_UNSIGNED_BYTE || componentType == COMPONENT_UNSIGNED_SHORT || componentType == COMPONENT_UNSIGNED_INT;
+		}
+		//Reads exactly the element size getAccessor checked. Other types must be rejected with isIndexType first
+		inline unsigned int readIndex(const Accessor& accessor, size_t e) {
+			const unsigned char* p = accessor.data + accessor.stride * e;
+			switch (accessor.componentType) {
+			case COMPONENT_UNSIGNED_BYTE: return *p;
+			case COMPONENT_UNSIGNED_SHORT: { uint16_t v; memcpy(&v, p, 2); return v; }
+			case COMPONENT_UNSIGNED_INT: { uint32_t v; memcpy(&v, p, 4); return v; }
+			default: return 0;
+			}
+		}
+
+		ew::Mat4 nodeTransform(const JsonValue& node) {
+			const JsonValue* matrix = node.find("matrix");
+			if (matrix && matrix->array.size() == 16) {
+				float m[16];
+				for (int i = 0; i < 16; i++)
+					m[i] = (float)matrix->array[i].number;
+				//glTF matrices are column major like ew::Mat4
+				return ew::Mat4(ew::Vec4(m[0], m[1], m[2], m[3]), ew::Vec4(m[4], m[5], m[6], m[7]),
+					ew::Vec4(m[8], m[9], m[10], m[11]), ew::Vec4(m[12], m[13], m[14], m[15]));
+			}
+			ew::Vec3 t(0), s(1);
+			ew::Quat r;
+			const JsonValue* translation = node.find("translation");
+			const JsonValue* rotation = node.find("rotation");
+			const JsonValue* scale = node.find("scale");
+			if (translation && translation->array.size() == 3)
+				t = ew::Vec3((float)translation->array[0].number, (float)translation->array[1].number, (float)translation->array[2].number);
+			if (rotation && rotation->array.size() == 4)
+				r = ew::Quat((float)rotation->array[0].number, (float)rotation->array[1].number, (float)rotation->array[2].number, (float)rotation->array[3].number);
+			if (scale && scale->array.size() == 3)
+				s = ew::Vec3((float)scale->array[0].number, (float)scale->array[1].number, (float)scale->array[2].number);
+			return ew::TRS(t, r, s);
+		}
+
+		//Appends every triangle primitive of a mesh, transformed by model. Returns false on invalid data
+		bool appendGlbMesh(const GlbDocument& document, const JsonValue& mesh, const ew::Mat4& model, bool transform, MeshData& meshData)
+		{
+			const JsonValue* primitives = mesh.find("primitives");
+			if (!primitives)
+				return true;
+			for (const JsonValue& primitive : primitives->array) {
+				//4 = TRIANGLES
+				if (primitive.getInt("mode", 4) != 4)
+					continue;
+				const JsonValue* attributes = primitive.find("attributes");
+				if (!attributes || !attributes->find("POSITION"))
+					continue;
+				Accessor positions, normals, uvs, indices;
+				if (!document.getAccessor(attributes->getInt("POSITION", -1), positions) || positions.numComponents != 3)
+					return false;
+				const bool hasNormals = attributes->find("NORMAL") != nullptr;
+				const bool hasUVs = attributes->find("TEXCOORD_0") != nullptr;
+				const bool hasIndices = primitive.find("indices") != nullptr;
+				if (hasNormals && (!document.getAccessor(attributes->getInt("NORMAL", -1), normals) || normals.numComponents != 3 || normals.count < positions.count))
+					return false;
+				if (hasUVs && (!document.getAccessor(attributes->getInt("TEXCOORD_0", -1), uvs) || uvs.numComponents != 2 || uvs.count < positions.count))
+					return false;
+				if (hasIndices && (!document.getAccessor(primitive.getInt("indices", -1), indices) || indices.numComponents != 1 || !isIndexType(indices.componentType)))
+					return false;
+
+				const size_t firstVertex = meshData.vertices.size();
+				const size_t firstIndex = meshData.indices.size();
+				meshData.vertices.resize(firstVertex + positions.count);
+				Vertex* vertices = meshData.vertices.data() + firstVertex;
+				for (size_t i = 0; i < positions.count; i++) {
+					vertices[i].pos = ew::Vec3(readFloat(positions, i, 0), readFloat(positions, i, 1), readFloat(positions, i, 2));
+					if (hasNormals)
+						vertices[i].normal = ew::Vec3(readFloat(normals, i, 0), readFloat(normals, i, 1), readFloat(normals, i, 2));
+					//glTF puts the uv origin at the top left, OpenGL at the bottom left
+					if (hasUVs)
+						vertices[i].uv = ew::Vec2(readFloat(uvs, i, 0), 1.0f - readFloat(uvs, i, 1));
+				}
+				const size_t numIndices = (hasIndices ? indices.count : positions.count) / 3 * 3;
+				meshData.indices.resize(firstIndex + numIndices);
+				for (size_t i = 0; i < numIndices; i++) {
+					const unsigned int index = hasIndices ? readIndex(indices, i) : (unsigned int)i;
+					if (index >= positions.count)
+						return false;
+					meshData.indices[firstIndex + i] = (unsigned int)firstVertex + index;
+				}
+				if (!hasNormals)
+					generateNormals(meshData, firstVertex, firstIndex, nullptr);
+				if (transform)
+					transformVertices(meshData, model, ew::NormalMatrix(model), firstVertex, positions.count);
+			}
+			return true;
+		}
+
+		//Nodes form a tree, so each is visited once. Revisiting means the file is malformed (and possibly cyclic)
+		bool appendGlbNode(const GlbDocument& document, int nodeIndex, const ew::Mat4& parent, bool transform, std::vector<bool>& visited, MeshData& meshData)
+		{
+			const JsonValue* node = document.json.at("nodes", nodeIndex);
+			if (!node || visited[nodeIndex])
+				return false;
+			visited[nodeIndex] = true;
+			const bool hasTransform = node->find("matrix") || node->find("translation") || node->find("rotation") || node->find("scale");
+			const ew::Mat4 model = hasTransform ? parent * nodeTransform(*node) : parent;
+			const JsonValue* mesh = document.json.at("meshes", node->getInt("mesh", -1));
+			if (mesh && !appendGlbMesh(document, *mesh, model, transform || hasTransform, meshData))
+				return false;
+			const JsonValue* children = node->find("children");
+			if (children) {
+				for (const JsonValue& child : children->array) {
+					if (!appendGlbNode(document, child.asIndex(), model, transform || hasTransform, visited, meshData))
+						return false;
+				}
+			}
+			return true;
+		}
+	}
+
+	/// <summary>
+	/// Validates the GLB container, parses the JSON chunk, then walks the scene graph appending each mesh.
+	/// Vertex data is read directly from the mapping with no intermediate buffer.
+	/// </summary>
+	/// <param name="filePath"></param>
+	/// <returns></returns>
+	MeshData loadGLB(const char* filePath)
+	{
+		MeshData meshData;
+		MappedFile file;
+		if (!file.open(filePath))
+			return meshData;
+		const unsigned char* data = file.getData();
+		const size_t size = file.getSize();
+		uint32_t header[5];
+		if (size < sizeof(header)) {
+			printf("%s is not a glTF binary file\n", filePath);
+			return meshData;
+		}
+		memcpy(header, data, sizeof(header));
+		if (header[0] != GLB_MAGIC || header[1] != 2 || header[4] != GLB_CHUNK_JSON || header[3] > size - sizeof(header)) {
+			printf("%s is not a glTF 2.0 binary file\n", filePath);
+			return meshData;
+		}
+		const char* json = (const char*)data + sizeof(header);
+		const size_t jsonLength = header[3];
+
+		GlbDocument document;
+		//The BIN chunk is optional and follows the JSON chunk
+		const size_t binHeader = sizeof(header) + jsonLength;
+		if (binHeader + 8 <= size) {
+			uint32_t chunk[2];
+			memcpy(chunk, data + binHeader, sizeof(chunk));
+			if (chunk[1] == GLB_CHUNK_BIN && chunk[0] <= size - binHeader - 8) {
+				document.bin = data + binHeader + 8;
+				document.binSize = chunk[0];
+			}
+		}
+		if (!JsonParser(json, json + jsonLength).parse(document.json) || document.json.type != JsonValue::OBJECT) {
+			printf("Failed to parse %s: invalid JSON\n", filePath);
+			return meshData;
+		}
+
+		bool ok = true;
+		const JsonValue* scene = document.json.at("scenes", document.json.getInt("scene", 0));
+		const JsonValue* roots = scene ? scene->find("nodes") : nullptr;
+		if (roots) {
+			const JsonValue* nodes = document.json.find("nodes");
+			std::vector<bool> visited(nodes ? nodes->array.size() : 0, false);
+			for (const JsonValue& root : roots->array) {
+				ok = ok && appendGlbNode(document, root.asIndex(), ew::IdentityMatrix(), false, visited, meshData);
+			}
+		}
+		else if (const JsonValue* meshes = document.json.find("meshes")) {
+			//No scene: take the meshes as they are
+			for (const JsonValue& mesh : meshes->array) {
+				ok = ok && appendGlbMesh(document, mesh, ew::IdentityMatrix(), false, meshData);
+			}
+		}
+		if (!ok) {
+			printf("Failed to load %s: invalid or unsupported mesh data\n", filePath);
+			return MeshData();
+		}
+		computeBounds(meshData);
+		return meshData;
+	}
+
+	MeshData loadModel(const char* filePath)
+	{
+		const char* extension = strrchr(filePath, '.');
+		if (extension) {
+			std::string lower(extension);
+			for (char& c : lower)
+				c = (char)tolower((unsigned char)c);
+			if (lower == ".obj")
+				return loadOBJ(filePath);
+			if (lower == ".glb")
+				return loadGLB(filePath);
+		}
+		printf("Unsupported model format %s\n", filePath);
+		return MeshData();
+	}
+}
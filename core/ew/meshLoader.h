@@ -0,0 +1,20 @@
+#pragma once
+#include "mesh.h"
+
+//Native loaders for common model formats. Each returns a single MeshData with every triangle in the file.
+//On failure an error is printed and empty MeshData is returned.
+namespace ew {
+	//Wavefront OBJ. The file is memory mapped and split into numThreads chunks at line boundaries that are parsed
+	//in parallel on ThreadPool::getShared() (0 = one per pool thread). Polygons are fan triangulated, and vertices are
+	//deduplicated per position/uv/normal triple. Missing normals are generated by averaging face normals.
+	//Materials, groups and lines are ignored.
+	MeshData loadOBJ(const char* filePath, unsigned int numThreads = 0);
+
+	//glTF 2.0 binary (.glb). Accessors are read straight out of the mapped BIN chunk.
+	//Triangle primitives of every mesh in the default scene are merged, with node transforms applied.
+	//Reads POSITION, NORMAL and TEXCOORD_0. External buffers, sparse accessors and compression extensions are not supported.
+	MeshData loadGLB(const char* filePath);
+
+	//Picks the loader from the file extension (.obj or .glb)
+	MeshData loadModel(const char* filePath);
+}
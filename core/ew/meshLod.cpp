@@ -0,0 +1,77 @@
+#include "meshLod.h"
+#include <math.h>
+#include <utility>
+
+namespace ew {
+	MeshLodSet::MeshLodSet(std::vector<MeshData> lods)
+	{
+		load(std::move(lods));
+	}
+	void MeshLodSet::load(std::vector<MeshData> lods)
+	{
+		m_lods.clear();
+		m_lods.reserve(lods.size());
+		for (MeshData& lod : lods)
+			m_lods.emplace_back(std::move(lod));
+		updateScreenSizes();
+	}
+	/// <summary>
+	/// Projects the bounding sphere of the finest level. Scale is taken from the longest axis of the model matrix.
+	/// </summary>
+	float MeshLodSet::getScreenSize(const Camera& camera, const ew::Mat4& model)const
+	{
+		if (m_lods.empty())
+			return 0.0f;
+		const Bounds& bounds = getBounds();
+		const ew::Vec4 center = model * ew::Vec4(bounds.center, 1.0f);
+		float scale = 0.0f;
+		for (int i = 0; i < 3; i++) {
+			const ew::Vec3 axis(model[i].x, model[i].y, model[i].z);
+			scale = fmaxf(scale, ew::Dot(axis, axis));
+		}
+		const float radius = bounds.radius * sqrtf(scale);
+
+		if (camera.orthographic) {
+			return 2.0f * radius / camera.orthoHeight;
+		}
+		const float distance = ew::Magnitude(ew::Vec3(center.x, center.y, center.z) - camera.position);
+		if (distance <= radius)
+			return 1.0f;
+		//Visible height at distance d is 2 * d * tan(fov / 2)
+		return radius / (distance * tanf(ew::Radians(camera.fov) * 0.5f));
+	}
+	int MeshLodSet::selectLod(float screenSize)const
+	{
+		const int numLods = (int)m_lods.size();
+		for (int i = 0; i < numLods - 1; i++) {
+			if (screenSize >= m_minScreenSizes[i])
+				return i;
+		}
+		return numLods - 1;
+	}
+	void MeshLodSet::draw(int lod, DrawMode drawMode)const
+	{
+		if (lod < 0 || lod >= (int)m_lods.size())
+			return;
+		m_lods[lod].draw(drawMode);
+	}
+	void MeshLodSet::setFullDetailSize(float screenSize)
+	{
+		m_fullDetailSize = screenSize;
+		updateScreenSizes();
+	}
+	/// <summary>
+	/// Triangles per screen area stay constant when a level with ratio r of the triangles is drawn at sqrt(r) of the size.
+	/// </summary>
+	void MeshLodSet::updateScreenSizes()
+	{
+		m_minScreenSizes.resize(m_lods.size());
+		if (m_lods.empty())
+			return;
+		const float fullTriangles = (float)m_lods[0].getNumIndices();
+		for (size_t i = 0; i < m_lods.size(); i++) {
+			const float ratio = fullTriangles > 0 ? m_lods[i].getNumIndices() / fullTriangles : 1.0f;
+			m_minScreenSizes[i] = m_fullDetailSize * sqrtf(ratio);
+		}
+	}
+}
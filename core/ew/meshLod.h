@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+#include "camera.h"
+
+namespace ew {
+	//A mesh uploaded at several levels of detail (see createLodChain), finest first.
+	//selectLod picks a level from how large the mesh appears on screen. Each level is used while its
+	//triangles would still be about as dense on screen as the full mesh at the full detail size.
+	class MeshLodSet {
+	public:
+		MeshLodSet() {};
+		MeshLodSet(std::vector<MeshData> lods);
+		//Uploads one Mesh per level. The MeshData is freed after upload
+		void load(std::vector<MeshData> lods);
+
+		//Height of the mesh's bounding sphere as a fraction of the screen height (1 = fills the screen vertically)
+		float getScreenSize(const Camera& camera, const ew::Mat4& model)const;
+		//Index of the coarsest level that is detailed enough at this screen size
+		int selectLod(float screenSize)const;
+		inline int selectLod(const Camera& camera, const ew::Mat4& model)const { return selectLod(getScreenSize(camera, model)); }
+		void draw(int lod, DrawMode drawMode = DrawMode::TRIANGLES)const;
+
+		inline int getNumLods()const { return (int)m_lods.size(); }
+		inline const Mesh& getLod(int lod)const { return m_lods[lod]; }
+		//Bounds of the finest level
+		inline const Bounds& getBounds()const { return m_lods[0].getBounds(); }
+		//Screen size at and above which level 0 is drawn. Larger values switch to coarser levels sooner
+		inline float getFullDetailSize()const { return m_fullDetailSize; }
+		void setFullDetailSize(float screenSize);
+	private:
+		void updateScreenSizes();
+
+		std::vector<Mesh> m_lods;
+		std::vector<float> m_minScreenSizes; //Smallest screen size each level is drawn at
+		float m_fullDetailSize = 0.5f;
+	};
+}
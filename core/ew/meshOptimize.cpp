@@ -0,0 +1,446 @@
+#include "meshOptimize.h"
+#include <algorithm>
+#include <string.h>
+#include <math.h>
+#include "threadPool.h"
+
+namespace ew {
+	void detail::buildTriangleAdjacency(const std::vector<unsigned int>& indices, size_t numVertices, std::vector<unsigned int>& offsets, std::vector<unsigned int>& triangles)
+	{
+		const size_t numIndices = indices.size() / 3 * 3;
+		offsets.assign(numVertices + 1, 0);
+		for (size_t i = 0; i < numIndices; i++)
+			offsets[indices[i] + 1]++;
+		for (size_t v = 0; v < numVertices; v++)
+			offsets[v + 1] += offsets[v];
+		triangles.resize(numIndices);
+		std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < numIndices; i++)
+			triangles[fill[indices[i]]++] = (unsigned int)(i / 3);
+	}
+
+	/// <summary>
+	/// Simulates a FIFO post-transform cache over the index buffer.
+	/// </summary>
+	/// <param name="cacheSize">Number of cached vertices. 16-32 matches most hardware</param>
+	/// <returns></returns>
+	VertexCacheStats analyzeVertexCache(const MeshData& meshData, unsigned int cacheSize)
+	{
+		VertexCacheStats stats;
+		const size_t numTriangles = meshData.indices.size() / 3;
+		if (numTriangles == 0 || cacheSize == 0)
+			return stats;
+
+		//cacheTime[v] is the transform count when v last entered the cache. It is cached while that is within cacheSize
+		std::vector<size_t> cacheTime(meshData.vertices.size(), 0);
+		std::vector<bool> referenced(meshData.vertices.size(), false);
+		size_t transforms = 0;
+		size_t numReferenced = 0;
+		for (size_t i = 0; i < numTriangles * 3; i++) {
+			const unsigned int v = meshData.indices[i];
+			if (cacheTime[v] == 0 || transforms - cacheTime[v] >= cacheSize) {
+				transforms++;
+				cacheTime[v] = transforms;
+			}
+			if (!referenced[v]) {
+				referenced[v] = true;
+				numReferenced++;
+			}
+		}
+		stats.acmr = (float)transforms / numTriangles;
+		stats.atvr = (float)transforms / numReferenced;
+		return stats;
+	}
+
+	/// <summary>
+	/// Tipsify (Sander, Nehab, Barczak 2007). Walks the mesh vertex by vertex, emitting every remaining triangle
+	/// around the current vertex, then moves to the neighbor that is still in cache and has the fewest triangles left.
+	/// Runs in linear time.
+	/// </summary>
+	/// <param name="meshData">Indices are rewritten in place</param>
+	/// <param name="cacheSize">Target cache size</param>
+	/// <returns>Starting index of each cluster</returns>
+	std::vector<unsigned int> optimizeVertexCache(MeshData& meshData, unsigned int cacheSize)
+	{
+		std::vector<unsigned int> clusters;
+		const std::vector<unsigned int>& indices = meshData.indices;
+		const size_t numVertices = meshData.vertices.size();
+		const size_t numTriangles = indices.size() / 3;
+		if (numTriangles == 0)
+			return clusters;
+
+		std::vector<unsigned int> adjacencyOffsets, adjacency;
+		detail::buildTriangleAdjacency(indices, numVertices, adjacencyOffsets, adjacency);
+
+		//Number of triangles around each vertex that are not emitted yet
+		std::vector<unsigned int> liveTriangles(numVertices);
+		for (size_t v = 0; v < numVertices; v++)
+			liveTriangles[v] = adjacencyOffsets[v + 1] - adjacencyOffsets[v];
+
+		std::vector<unsigned int> cacheTime(numVertices, 0);
+		std::vector<bool> emitted(numTriangles, false);
+		std::vector<unsigned int> deadEnd;
+		std::vector<unsigned int> candidates;
+		std::vector<unsigned int> output;
+		output.reserve(numTriangles * 3);
+
+		unsigned int time = cacheSize + 1;
+		size_t cursor = 0;
+		int fanning = (int)indices[0];
+		clusters.push_back(0);
+		while (fanning >= 0) {
+			candidates.clear();
+			for (unsigned int a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; a++) {
+				const unsigned int t = adjacency[a];
+				if (emitted[t])
+					continue;
+				for (int k = 0; k < 3; k++) {
+					const unsigned int v = indices[t * 3 + k];
+					output.push_back(v);
+					deadEnd.push_back(v);
+					candidates.push_back(v);
+					liveTriangles[v]--;
+					if (time - cacheTime[v] > cacheSize) {
+						cacheTime[v] = time;
+						time++;
+					}
+				}
+				emitted[t] = true;
+			}
+
+			//Prefer the candidate that will still be in cache after its remaining triangles are emitted, and is oldest
+			int next = -1;
+			int bestPriority = -1;
+			for (unsigned int v : candidates) {
+				if (liveTriangles[v] == 0)
+					continue;
+				int priority = 0;
+				if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+					priority = (int)(time - cacheTime[v]);
+				if (priority > bestPriority) {
+					bestPriority = priority;
+					next = (int)v;
+				}
+			}
+
+			if (next == -1) {
+				//Dead end: back up through recently used vertices, then fall back to a linear scan
+				while (!deadEnd.empty()) {
+					const unsigned int v = deadEnd.back();
+					deadEnd.pop_back();
+					if (liveTriangles[v] > 0) {
+						next = (int)v;
+						break;
+					}
+				}
+				while (next == -1 && cursor < numVertices) {
+					if (liveTriangles[cursor] > 0)
+						next = (int)cursor;
+					cursor++;
+				}
+				if (next != -1)
+					clusters.push_back((unsigned int)output.size());
+			}
+			fanning = next;
+		}
+
+		meshData.indices.swap(output);
+		return clusters;
+	}
+
+	/// <summary>
+	/// Sorts clusters by occlusion potential, dot(cluster centroid - mesh centroid, cluster normal), highest first.
+	/// Clusters on the outside of the mesh draw before the ones they would hide (Sander et al. 2007).
+	/// </summary>
+	/// <param name="meshData">Indices are rewritten in place</param>
+	/// <param name="clusters">Cluster start offsets from optimizeVertexCache</param>
+	void optimizeOverdraw(MeshData& meshData, const std::vector<unsigned int>& clusters)
+	{
+		const std::vector<unsigned int>& indices = meshData.indices;
+		const size_t numClusters = clusters.size();
+		if (numClusters < 2)
+			return;
+
+		struct Cluster {
+			unsigned int start;
+			unsigned int end;
+			ew::Vec3 centroid;
+			ew::Vec3 normal;
+			float sortKey;
+		};
+		std::vector<Cluster> sorted(numClusters);
+		ew::Vec3 meshCentroid = ew::Vec3(0);
+		float meshArea = 0;
+		for (size_t c = 0; c < numClusters; c++) {
+			Cluster& cluster = sorted[c];
+			cluster.start = clusters[c];
+			cluster.end = c + 1 < numClusters ? clusters[c + 1] : (unsigned int)indices.size();
+			cluster.centroid = ew::Vec3(0);
+			cluster.normal = ew::Vec3(0);
+			float area = 0;
+			for (unsigned int i = cluster.start; i < cluster.end; i += 3) {
+				const ew::Vec3& p0 = meshData.vertices[indices[i]].pos;
+				const ew::Vec3& p1 = meshData.vertices[indices[i + 1]].pos;
+				const ew::Vec3& p2 = meshData.vertices[indices[i + 2]].pos;
+				//Length of the cross product is twice the triangle area
+				const ew::Vec3 n = ew::Cross(p1 - p0, p2 - p0);
+				const float triArea = ew::Magnitude(n) * 0.5f;
+				cluster.normal += n;
+				cluster.centroid += (p0 + p1 + p2) * (triArea / 3.0f);
+				area += triArea;
+			}
+			meshCentroid += cluster.centroid;
+			meshArea += area;
+			if (area > 0)
+				cluster.centroid = cluster.centroid / area;
+			cluster.normal = ew::Normalize(cluster.normal);
+		}
+		if (meshArea > 0)
+			meshCentroid = meshCentroid / meshArea;
+
+		for (Cluster& cluster : sorted)
+			cluster.sortKey = ew::Dot(cluster.centroid - meshCentroid, cluster.normal);
+		std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+		std::vector<unsigned int> output;
+		output.reserve(indices.size());
+		for (const Cluster& cluster : sorted)
+			output.insert(output.end(), indices.begin() + cluster.start, indices.begin() + cluster.end);
+		meshData.indices.swap(output);
+	}
+
+	/// <summary>
+	/// Renumbers vertices in order of first use by the index buffer.
+	/// </summary>
+	/// <param name="meshData">Vertices and indices are rewritten in place</param>
+	void optimizeVertexFetch(MeshData& meshData)
+	{
+		const unsigned int UNUSED = ~0u;
+		std::vector<unsigned int> remap(meshData.vertices.size(), UNUSED);
+		std::vector<Vertex> vertices;
+		vertices.reserve(meshData.vertices.size());
+		for (unsigned int& index : meshData.indices) {
+			if (remap[index] == UNUSED) {
+				remap[index] = (unsigned int)vertices.size();
+				vertices.push_back(meshData.vertices[index]);
+			}
+			index = remap[index];
+		}
+		meshData.vertices.swap(vertices);
+	}
+
+	/// <summary>
+	/// Vertex cache, overdraw and vertex fetch optimization in that order.
+	/// </summary>
+	/// <param name="meshData">Mesh to optimize in place</param>
+	/// <param name="cacheSize">Cache size used for both optimizing and the reported statistics</param>
+	/// <returns>ACMR/ATVR before and after</returns>
+	MeshOptimizeReport optimizeMesh(MeshData& meshData, unsigned int cacheSize)
+	{
+		MeshOptimizeReport report;
+		report.before = analyzeVertexCache(meshData, cacheSize);
+		std::vector<unsigned int> clusters = optimizeVertexCache(meshData, cacheSize);
+		//Keep the cluster order only if it costs less than 5% in cache efficiency
+		const float cacheOrderACMR = analyzeVertexCache(meshData, cacheSize).acmr;
+		std::vector<unsigned int> cacheOrder = meshData.indices;
+		optimizeOverdraw(meshData, clusters);
+		if (analyzeVertexCache(meshData, cacheSize).acmr > cacheOrderACMR * 1.05f)
+			meshData.indices.swap(cacheOrder);
+		optimizeVertexFetch(meshData);
+		report.after = analyzeVertexCache(meshData, cacheSize);
+		report.numClusters = clusters.size();
+		return report;
+	}
+
+	static uint64_t mixHash(uint64_t h)
+	{
+		//splitmix64 finalizer
+		h ^= h >> 30;
+		h *= 0xbf58476d1ce4e5b9ull;
+		h ^= h >> 27;
+		h *= 0x94d049bb133111ebull;
+		h ^= h >> 31;
+		return h;
+	}
+
+	static uint64_t hashVertexBits(const Vertex& v)
+	{
+		uint32_t words[sizeof(Vertex) / 4];
+		memcpy(words, &v, sizeof(Vertex));
+		uint64_t h = 0;
+		for (uint32_t word : words)
+			h = mixHash(h ^ word);
+		return h;
+	}
+
+	static uint64_t hashCell(long long x, long long y, long long z)
+	{
+		return mixHash(mixHash(mixHash((uint64_t)x) ^ (uint64_t)y) ^ (uint64_t)z);
+	}
+
+	static bool isNear(const Vertex& a, const Vertex& b, float epsilon)
+	{
+		const float* fa = &a.pos.x;
+		const float* fb = &b.pos.x;
+		for (size_t k = 0; k < sizeof(Vertex) / sizeof(float); k++) {
+			if (fabsf(fa[k] - fb[k]) > epsilon)
+				return false;
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Hash based vertex welding.
+	/// 1. Hash every vertex: its bits, or its position cell (cell size = 2 * epsilon) when welding near vertices.
+	/// 2. Sort (hash, vertex) pairs into shards, one per thread, and index each run of equal hashes with an open addressing table.
+	/// 3. For each vertex find the lowest earlier vertex it matches. When epsilon > 0 a match can only be in the
+	///    vertex's own cell or the neighbor on the nearer side along each axis, so 8 cells are searched.
+	/// 4. Resolve chains of matches, compact the vertex array and remap indices.
+	/// Steps 1-3 and the index remap run in parallel.
+	/// </summary>
+	/// <param name="meshData">Vertices and indices are rewritten in place. Bounds are unchanged.</param>
+	/// <param name="epsilon">Per component tolerance. 0 for exact matches only</param>
+	/// <returns>Vertex counts and vertex memory saved</returns>
+	WeldReport weldVertices(MeshData& meshData, float epsilon)
+	{
+		WeldReport report;
+		const size_t numVertices = meshData.vertices.size();
+		report.verticesBefore = numVertices;
+		report.verticesAfter = numVertices;
+		if (numVertices == 0)
+			return report;
+
+		const bool exact = !(epsilon > 0);
+		const float invCellSize = exact ? 0.0f : 0.5f / epsilon;
+		const Vertex* vertices = meshData.vertices.data();
+
+		//Work is split over the shared pool in ranges of this many items, so small meshes run inline
+		ThreadPool& pool = ThreadPool::getShared();
+		const size_t MIN_VERTICES_PER_THREAD = 16384;
+		const unsigned int numShards = (unsigned int)std::min<size_t>(pool.getNumThreads(), std::max<size_t>(1, numVertices / MIN_VERTICES_PER_THREAD));
+
+		//1. Hashes
+		std::vector<uint64_t> hashes(numVertices);
+		pool.parallelFor(numVertices, MIN_VERTICES_PER_THREAD, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				const ew::Vec3& p = vertices[i].pos;
+				hashes[i] = exact ? hashVertexBits(vertices[i])
+					: hashCell((long long)floorf(p.x * invCellSize), (long long)floorf(p.y * invCellSize), (long long)floorf(p.z * invCellSize));
+			}
+		});
+
+		//2. Shards of (hash, vertex index), sorted so matches come out lowest index first.
+		//Each shard has a table from hash to its run of entries.
+		typedef std::pair<uint64_t, unsigned int> Entry;
+		struct Run {
+			uint64_t hash;
+			unsigned int begin;
+			unsigned int end; //0 marks an empty slot
+		};
+		struct Shard {
+			std::vector<Entry> entries;
+			std::vector<Run> table;
+			size_t mask = 0;
+		};
+		std::vector<Shard> shards(numShards);
+		pool.parallelFor(numShards, 1, [&](size_t firstShard, size_t lastShard) {
+			for (size_t t = firstShard; t < lastShard; t++) {
+				Shard& shard = shards[t];
+				shard.entries.reserve(numVertices / numShards + 1);
+				for (size_t i = 0; i < numVertices; i++) {
+					if (hashes[i] % numShards == t)
+						shard.entries.push_back(Entry(hashes[i], (unsigned int)i));
+				}
+				std::sort(shard.entries.begin(), shard.entries.end());
+
+				size_t tableSize = 16;
+				while (tableSize < shard.entries.size() * 2)
+					tableSize *= 2;
+				shard.table.assign(tableSize, Run{ 0, 0, 0 });
+				shard.mask = tableSize - 1;
+				for (size_t begin = 0; begin < shard.entries.size();) {
+					const uint64_t hash = shard.entries[begin].first;
+					size_t end = begin + 1;
+					while (end < shard.entries.size() && shard.entries[end].first == hash)
+						end++;
+					size_t slot = (hash >> 32) & shard.mask;
+					while (shard.table[slot].end != 0)
+						slot = (slot + 1) & shard.mask;
+					shard.table[slot] = Run{ hash, (unsigned int)begin, (unsigned int)end };
+					begin = end;
+				}
+			}
+		});
+
+		//3. Lowest matching vertex for each vertex
+		std::vector<unsigned int> remap(numVertices);
+		pool.parallelFor(numVertices, MIN_VERTICES_PER_THREAD, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				unsigned int match = (unsigned int)i;
+				auto search = [&](uint64_t hash) {
+					const Shard& shard = shards[hash % numShards];
+					size_t slot = (hash >> 32) & shard.mask;
+					while (shard.table[slot].end != 0 && shard.table[slot].hash != hash)
+						slot = (slot + 1) & shard.mask;
+					const Run& run = shard.table[slot];
+					for (unsigned int e = run.begin; e < run.end && shard.entries[e].second < match; e++) {
+						const unsigned int other = shard.entries[e].second;
+						const bool matches = exact
+							? memcmp(&vertices[other], &vertices[i], sizeof(Vertex)) == 0
+							: isNear(vertices[other], vertices[i], epsilon);
+						if (matches) {
+							match = other;
+							break;
+						}
+					}
+				};
+				if (exact) {
+					search(hashes[i]);
+				}
+				else {
+					//Cell coordinates and the direction of the nearer neighbor on each axis
+					const float* p = &vertices[i].pos.x;
+					long long cell[3];
+					int side[3];
+					for (int k = 0; k < 3; k++) {
+						const float scaled = p[k] * invCellSize;
+						cell[k] = (long long)floorf(scaled);
+						side[k] = scaled - floorf(scaled) < 0.5f ? -1 : 1;
+					}
+					for (int n = 0; n < 8; n++) {
+						search(hashCell(
+							cell[0] + ((n & 1) ? side[0] : 0),
+							cell[1] + ((n & 2) ? side[1] : 0),
+							cell[2] + ((n & 4) ? side[2] : 0)));
+					}
+				}
+				remap[i] = match;
+			}
+		});
+		//4. Matches always point to a lower index, so one forward pass resolves chains and assigns new indices
+		std::vector<Vertex> welded;
+		welded.reserve(numVertices);
+		for (size_t i = 0; i < numVertices; i++) {
+			if (remap[i] == i) {
+				remap[i] = (unsigned int)welded.size();
+				welded.push_back(vertices[i]);
+			}
+			else {
+				remap[i] = remap[remap[i]];
+			}
+		}
+
+		const size_t numIndices = meshData.indices.size();
+		unsigned int* indices = meshData.indices.data();
+		pool.parallelFor(numIndices, MIN_VERTICES_PER_THREAD, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+				indices[i] = remap[indices[i]];
+		});
+
+		welded.shrink_to_fit();
+		meshData.vertices.swap(welded);
+		report.verticesAfter = meshData.vertices.size();
+		report.bytesSaved = (report.verticesBefore - report.verticesAfter) * sizeof(Vertex);
+		return report;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+
+//Index and vertex reordering for MeshData. Nothing here changes what is drawn, only the order it is drawn in
+//(or, for weldVertices, how many vertices it takes).
+//Typical use is optimizeMesh() once after generating or loading, before Mesh::load.
+//All indices must be smaller than the number of vertices.
+namespace ew {
+	//Post-transform vertex cache statistics, simulated with a FIFO cache.
+	//acmr: vertex shader invocations per triangle (0.5 is ideal for large regular meshes, 3 is worst)
+	//atvr: vertex shader invocations per referenced vertex (1 is ideal)
+	struct VertexCacheStats {
+		float acmr = 0;
+		float atvr = 0;
+	};
+
+	struct MeshOptimizeReport {
+		VertexCacheStats before;
+		VertexCacheStats after;
+		size_t numClusters = 0;
+	};
+
+	VertexCacheStats analyzeVertexCache(const MeshData& meshData, unsigned int cacheSize = 16);
+
+	//Reorders triangles for the post-transform cache (Tipsify).
+	//Returns the first index of each cluster: runs of triangles that were emitted without a cache restart.
+	std::vector<unsigned int> optimizeVertexCache(MeshData& meshData, unsigned int cacheSize = 16);
+
+	//Reorders whole clusters from optimizeVertexCache so outward facing ones draw first, which reduces overdraw.
+	//Triangle order inside a cluster is kept, so cache efficiency is mostly preserved.
+	void optimizeOverdraw(MeshData& meshData, const std::vector<unsigned int>& clusters);
+
+	//Reorders vertices into the order the index buffer first uses them, so vertex fetches walk memory linearly.
+	//Vertices that are not referenced by any triangle are removed.
+	void optimizeVertexFetch(MeshData& meshData);
+
+	//Runs all three passes and returns cache statistics from before and after
+	MeshOptimizeReport optimizeMesh(MeshData& meshData, unsigned int cacheSize = 16);
+
+	struct WeldReport {
+		size_t verticesBefore = 0;
+		size_t verticesAfter = 0;
+		size_t bytesSaved = 0;
+	};
+
+	//Merges duplicate vertices and remaps indices. Large meshes are split over ThreadPool::getShared().
+	//epsilon = 0 merges bit identical vertices only. Otherwise vertices merge when every
+	//position, normal and uv component is within epsilon of an earlier vertex.
+	WeldReport weldVertices(MeshData& meshData, float epsilon = 0.0f);
+
+	//Helpers shared by the mesh processing code, not meant to be called directly
+	namespace detail {
+		//Vertex -> triangle adjacency as offsets into one array: the triangles using vertex v are
+		//triangles[offsets[v]] to triangles[offsets[v + 1] - 1]. A trailing partial triangle is ignored
+		void buildTriangleAdjacency(const std::vector<unsigned int>& indices, size_t numVertices, std::vector<unsigned int>& offsets, std::vector<unsigned int>& triangles);
+	}
+}
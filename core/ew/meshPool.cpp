@@ -0,0 +1,289 @@
+#include "meshPool.h"
+#include <stdio.h>
+#include <algorithm>
+#include "external/glad.h"
+
+namespace ew {
+	void MeshPool::FreeList::reset(size_t capacity)
+	{
+		m_free.clear();
+		if (capacity > 0)
+			m_free.push_back(Block{ 0, capacity });
+	}
+	bool MeshPool::FreeList::allocate(size_t size, Block* block)
+	{
+		if (size == 0) {
+			*block = Block{ 0, 0 };
+			return true;
+		}
+		for (size_t i = 0; i < m_free.size(); i++) {
+			if (m_free[i].size < size)
+				continue;
+			*block = Block{ m_free[i].offset, size };
+			m_free[i].offset += size;
+			m_free[i].size -= size;
+			if (m_free[i].size == 0)
+				m_free.erase(m_free.begin() + i);
+			return true;
+		}
+		return false;
+	}
+	void MeshPool::FreeList::free(const Block& block)
+	{
+		if (block.size == 0)
+			return;
+		auto it = std::lower_bound(m_free.begin(), m_free.end(), block, [](const Block& a, const Block& b) { return a.offset < b.offset; });
+		it = m_free.insert(it, block);
+		//Merge with the next block, then the previous one
+		auto next = it + 1;
+		if (next != m_free.end() && it->offset + it->size == next->offset) {
+			it->size += next->size;
+			m_free.erase(next);
+		}
+		if (it != m_free.begin()) {
+			auto prev = it - 1;
+			if (prev->offset + prev->size == it->offset) {
+				prev->size += it->size;
+				m_free.erase(it);
+			}
+		}
+	}
+	size_t MeshPool::FreeList::getFree() const
+	{
+		size_t total = 0;
+		for (const Block& block : m_free)
+			total += block.size;
+		return total;
+	}
+
+	MeshPool::MeshPool(size_t maxVertices, size_t maxIndices)
+	{
+		create(maxVertices, maxIndices);
+	}
+	MeshPool::~MeshPool()
+	{
+		if (m_vao == 0)
+			return;
+		glDeleteBuffers(1, &m_vbo);
+		glDeleteBuffers(1, &m_ebo);
+		glDeleteBuffers(1, &m_instanceBuffer);
+		glDeleteBuffers(1, &m_indirectBuffer);
+		glDeleteVertexArrays(1, &m_vao);
+	}
+	/// <summary>
+	/// Allocates the shared vertex and index buffers.
+	/// </summary>
+	/// <param name="maxVertices">Total vertices across all meshes</param>
+	/// <param name="maxIndices">Total indices across all meshes</param>
+	void MeshPool::create(size_t maxVertices, size_t maxIndices)
+	{
+		if (m_vao != 0)
+			return;
+		m_maxVertices = maxVertices;
+		m_maxIndices = maxIndices;
+		m_vertexAllocator.reset(maxVertices);
+		m_indexAllocator.reset(maxIndices);
+
+		glGenVertexArrays(1, &m_vao);
+		glGenBuffers(1, &m_vbo);
+		glGenBuffers(1, &m_ebo);
+		glGenBuffers(1, &m_instanceBuffer);
+		glGenBuffers(1, &m_indirectBuffer);
+
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * maxVertices, NULL, GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_ebo);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(unsigned int) * maxIndices, NULL, GL_STATIC_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		setVertexAttributes();
+	}
+	void MeshPool::setVertexAttributes()
+	{
+		glBindVertexArray(m_vao);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, pos));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, normal));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, uv));
+		glEnableVertexAttribArray(2);
+
+		//One InstanceData per draw, selected by the command's baseInstance
+		setInstanceAttributes(m_instanceBuffer);
+
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+	/// <summary>
+	/// Uploads a mesh into free space in the shared buffers. Defragments once if it does not fit.
+	/// </summary>
+	/// <returns>Handle for draw/remove, or -1 if there is not enough space</returns>
+	int MeshPool::add(const MeshData& meshData)
+	{
+		if (m_vao == 0)
+			return -1;
+		Allocation allocation;
+		bool fits = m_vertexAllocator.allocate(meshData.vertices.size(), &allocation.vertices);
+		if (fits && !m_indexAllocator.allocate(meshData.indices.size(), &allocation.indices)) {
+			m_vertexAllocator.free(allocation.vertices);
+			fits = false;
+		}
+		if (!fits) {
+			if (meshData.vertices.size() > m_vertexAllocator.getFree() || meshData.indices.size() > m_indexAllocator.getFree()) {
+				printf("MeshPool is full (%d vertices, %d indices requested)\n", (int)meshData.vertices.size(), (int)meshData.indices.size());
+				return -1;
+			}
+			defragment();
+			m_vertexAllocator.allocate(meshData.vertices.size(), &allocation.vertices);
+			m_indexAllocator.allocate(meshData.indices.size(), &allocation.indices);
+		}
+		allocation.bounds = meshData.bounds;
+		if (allocation.bounds.isEmpty()) {
+			MeshData copy;
+			copy.vertices = meshData.vertices;
+			computeBounds(copy);
+			allocation.bounds = copy.bounds;
+		}
+		allocation.alive = true;
+
+		if (allocation.vertices.size > 0) {
+			glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+			glBufferSubData(GL_ARRAY_BUFFER, sizeof(Vertex) * allocation.vertices.offset, sizeof(Vertex) * allocation.vertices.size, meshData.vertices.data());
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+		if (allocation.indices.size > 0) {
+			//Use a binding point that is not part of any VAO
+			glBindBuffer(GL_COPY_WRITE_BUFFER, m_ebo);
+			glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(unsigned int) * allocation.indices.offset, sizeof(unsigned int) * allocation.indices.size, meshData.indices.data());
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		}
+
+		int handle;
+		if (!m_freeHandles.empty()) {
+			handle = m_freeHandles.back();
+			m_freeHandles.pop_back();
+			m_allocations[handle] = allocation;
+		}
+		else {
+			handle = (int)m_allocations.size();
+			m_allocations.push_back(allocation);
+		}
+		return handle;
+	}
+	void MeshPool::remove(int mesh)
+	{
+		if (mesh < 0 || mesh >= (int)m_allocations.size() || !m_allocations[mesh].alive)
+			return;
+		Allocation& allocation = m_allocations[mesh];
+		m_vertexAllocator.free(allocation.vertices);
+		m_indexAllocator.free(allocation.indices);
+		allocation = Allocation();
+		m_freeHandles.push_back(mesh);
+	}
+	/// <summary>
+	/// Copies every live mesh, in offset order, to the front of new buffers on the GPU and swaps them in.
+	/// Indices are relative to each mesh's base vertex, so they do not need rewriting.
+	/// </summary>
+	void MeshPool::defragment()
+	{
+		if (m_vao == 0)
+			return;
+		unsigned int newBuffers[2];
+		glGenBuffers(2, newBuffers);
+
+		std::vector<int> order;
+		for (int i = 0; i < (int)m_allocations.size(); i++) {
+			if (m_allocations[i].alive)
+				order.push_back(i);
+		}
+
+		//Vertices
+		std::sort(order.begin(), order.end(), [&](int a, int b) { return m_allocations[a].vertices.offset < m_allocations[b].vertices.offset; });
+		glBindBuffer(GL_COPY_READ_BUFFER, m_vbo);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffers[0]);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(Vertex) * m_maxVertices, NULL, GL_STATIC_DRAW);
+		size_t vertexEnd = 0;
+		for (int i : order) {
+			Block& block = m_allocations[i].vertices;
+			if (block.size > 0)
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sizeof(Vertex) * block.offset, sizeof(Vertex) * vertexEnd, sizeof(Vertex) * block.size);
+			block.offset = vertexEnd;
+			vertexEnd += block.size;
+		}
+
+		//Indices
+		std::sort(order.begin(), order.end(), [&](int a, int b) { return m_allocations[a].indices.offset < m_allocations[b].indices.offset; });
+		glBindBuffer(GL_COPY_READ_BUFFER, m_ebo);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffers[1]);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(unsigned int) * m_maxIndices, NULL, GL_STATIC_DRAW);
+		size_t indexEnd = 0;
+		for (int i : order) {
+			Block& block = m_allocations[i].indices;
+			if (block.size > 0)
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sizeof(unsigned int) * block.offset, sizeof(unsigned int) * indexEnd, sizeof(unsigned int) * block.size);
+			block.offset = indexEnd;
+			indexEnd += block.size;
+		}
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		glDeleteBuffers(1, &m_vbo);
+		glDeleteBuffers(1, &m_ebo);
+		m_vbo = newBuffers[0];
+		m_ebo = newBuffers[1];
+		setVertexAttributes();
+
+		m_vertexAllocator.reset(m_maxVertices);
+		m_indexAllocator.reset(m_maxIndices);
+		Block used;
+		m_vertexAllocator.allocate(vertexEnd, &used);
+		m_indexAllocator.allocate(indexEnd, &used);
+	}
+	/// <summary>
+	/// Writes one indirect command and one InstanceData per mesh, then issues a single multi-draw.
+	/// Shaders must take their model and normal matrices from the instanced attributes.
+	/// </summary>
+	/// <param name="meshes">Handles from add()</param>
+	/// <param name="instances">One per handle</param>
+	/// <param name="count">Number of draws</param>
+	void MeshPool::draw(const int* meshes, const InstanceData* instances, size_t count)
+	{
+		if (m_vao == 0 || count == 0)
+			return;
+		m_commands.clear();
+		m_commands.resize(count);
+		for (size_t i = 0; i < count; i++) {
+			const Allocation& allocation = m_allocations[meshes[i]];
+			DrawElementsIndirectCommand& command = m_commands[i];
+			command.count = (unsigned int)allocation.indices.size;
+			command.instanceCount = 1;
+			command.firstIndex = (unsigned int)allocation.indices.offset;
+			command.baseVertex = (int)allocation.vertices.offset;
+			command.baseInstance = (unsigned int)i;
+		}
+
+		//Per draw buffers are only reallocated when they grow, otherwise refilled in place
+		if (count > m_drawCapacity) {
+			m_drawCapacity = std::max(count, m_drawCapacity * 2);
+			glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+			glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceData) * m_drawCapacity, NULL, GL_STREAM_DRAW);
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+			glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand) * m_drawCapacity, NULL, GL_STREAM_DRAW);
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(InstanceData) * count, instances);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(DrawElementsIndirectCommand) * count, m_commands.data());
+
+		glBindVertexArray(m_vao);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, NULL, (GLsizei)count, 0);
+		glBindVertexArray(0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+
+namespace ew {
+	//Many meshes packed into one vertex buffer and one index buffer, sharing a single VAO.
+	//Meshes are sub-allocated with a first fit free list. When an allocation does not fit,
+	//live meshes are compacted to the front of the buffers (handles stay valid) and the allocation is retried.
+	//draw() submits any number of meshes with one glMultiDrawElementsIndirect call. Requires OpenGL 4.3.
+	class MeshPool {
+	public:
+		MeshPool() {};
+		MeshPool(size_t maxVertices, size_t maxIndices);
+		~MeshPool();
+		MeshPool(const MeshPool&) = delete;
+		MeshPool& operator=(const MeshPool&) = delete;
+
+		void create(size_t maxVertices, size_t maxIndices);
+		//Returns a handle to the uploaded mesh, or -1 if the pool is full
+		int add(const MeshData& meshData);
+		void remove(int mesh);
+		//Moves all meshes to the front of the buffers so free space is contiguous
+		void defragment();
+
+		//Draws meshes[i] with instances[i] in one call
+		void draw(const int* meshes, const InstanceData* instances, size_t count);
+
+		inline const Bounds& getBounds(int mesh)const { return m_allocations[mesh].bounds; }
+		inline int getNumVertices(int mesh)const { return (int)m_allocations[mesh].vertices.size; }
+		inline int getNumIndices(int mesh)const { return (int)m_allocations[mesh].indices.size; }
+		inline size_t getFreeVertices()const { return m_vertexAllocator.getFree(); }
+		inline size_t getFreeIndices()const { return m_indexAllocator.getFree(); }
+	private:
+		struct Block {
+			size_t offset = 0;
+			size_t size = 0;
+		};
+		//First fit allocator over [0, capacity). Free blocks are kept sorted by offset and merged when adjacent
+		class FreeList {
+		public:
+			void reset(size_t capacity);
+			bool allocate(size_t size, Block* block);
+			void free(const Block& block);
+			size_t getFree()const;
+		private:
+			std::vector<Block> m_free;
+		};
+		struct Allocation {
+			Block vertices;
+			Block indices;
+			Bounds bounds;
+			bool alive = false;
+		};
+		void setVertexAttributes();
+
+		unsigned int m_vao = 0;
+		unsigned int m_vbo = 0;
+		unsigned int m_ebo = 0;
+		unsigned int m_instanceBuffer = 0;
+		unsigned int m_indirectBuffer = 0;
+		size_t m_maxVertices = 0;
+		size_t m_maxIndices = 0;
+		size_t m_drawCapacity = 0; //Draws the instance and indirect buffers can hold
+		std::vector<DrawElementsIndirectCommand> m_commands; //Reused by draw()
+		FreeList m_vertexAllocator;
+		FreeList m_indexAllocator;
+		std::vector<Allocation> m_allocations; //Indexed by handle
+		std::vector<int> m_freeHandles;
+	};
+}
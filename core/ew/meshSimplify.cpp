@@ -0,0 +1,402 @@
+#include "meshSimplify.h"
+#include "meshOptimize.h"
+#include <algorithm>
+#include <string.h>
+#include <math.h>
+
+namespace ew {
+	namespace {
+		//Symmetric 4x4 plane quadric, accumulated with weights. Evaluates to the weighted mean squared plane distance
+		struct Quadric {
+			double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+			double a11 = 0, a12 = 0, a13 = 0;
+			double a22 = 0, a23 = 0;
+			double a33 = 0;
+			double weight = 0;
+
+			void addPlane(const ew::Vec3& n, float d, float w) {
+				a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z; a03 += w * n.x * d;
+				a11 += w * n.y * n.y; a12 += w * n.y * n.z; a13 += w * n.y * d;
+				a22 += w * n.z * n.z; a23 += w * n.z * d;
+				a33 += w * d * d;
+				weight += w;
+			}
+			void add(const Quadric& q) {
+				a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+				a11 += q.a11; a12 += q.a12; a13 += q.a13;
+				a22 += q.a22; a23 += q.a23;
+				a33 += q.a33;
+				weight += q.weight;
+			}
+			float evaluate(const ew::Vec3& p)const {
+				const double x = p.x, y = p.y, z = p.z;
+				const double r = a00 * x * x + a11 * y * y + a22 * z * z + a33
+					+ 2.0 * (a01 * x * y + a02 * x * z + a03 * x + a12 * y * z + a13 * y + a23 * z);
+				return weight > 0 ? (float)(fabs(r) / weight) : 0.0f;
+			}
+		};
+
+		//How a vertex may move. Decided once from the input topology
+		enum VertexKind : unsigned char {
+			KIND_MANIFOLD, //Interior vertex, no siblings. Collapses in any direction
+			KIND_BORDER,   //On one open border. Collapses along the border
+			KIND_SEAM,     //Split in two along a seam. Both halves collapse along the seam together
+			KIND_LOCKED    //Anything else (corners, non-manifold). Never collapses, but can be collapsed onto
+		};
+
+		const float BORDER_WEIGHT = 10.0f;
+		const float SEAM_WEIGHT = 1.0f;
+		const float NORMAL_WEIGHT = 0.001f;
+		//Collapses that rotate a triangle further than about 75 degrees are rejected
+		const float MIN_NORMAL_COS = 0.25f;
+
+		struct Collapse {
+			unsigned int from; //Positions (canonical vertices)
+			unsigned int to;
+			float error;
+		};
+
+		ew::Vec3 triangleNormal(const ew::Vec3& a, const ew::Vec3& b, const ew::Vec3& c)
+		{
+			return ew::Cross(b - a, c - a);
+		}
+	}
+
+	/// <summary>
+	/// Greedy edge collapse in passes. Each pass ranks every allowed collapse by quadric error, then performs the cheapest ones
+	/// that do not touch each other, so errors are always evaluated against an up to date neighborhood.
+	/// Vertices that share a position are treated as one position with several wedges (one per distinct normal/uv).
+	/// All wedges of a position move together, each onto the matching wedge of the target.
+	/// </summary>
+	/// <param name="meshData">Simplified in place</param>
+	/// <param name="targetRatio">Fraction of triangles to keep, 0-1</param>
+	/// <param name="maxError">Largest allowed error, relative to the mesh size</param>
+	/// <returns></returns>
+	SimplifyReport simplifyMesh(MeshData& meshData, float targetRatio, float maxError)
+	{
+		SimplifyReport report;
+		std::vector<unsigned int>& indices = meshData.indices;
+		const size_t numVertices = meshData.vertices.size();
+		report.trianglesBefore = report.trianglesAfter = indices.size() / 3;
+		const size_t targetIndices = (size_t)(report.trianglesBefore * std::max(0.0f, targetRatio)) * 3;
+		if (numVertices == 0 || indices.size() <= targetIndices)
+			return report;
+
+		//Work in a unit sized space so errors do not depend on mesh scale
+		if (meshData.bounds.isEmpty())
+			computeBounds(meshData);
+		const ew::Vec3 size = meshData.bounds.max - meshData.bounds.min;
+		const float maxSide = std::max(size.x, std::max(size.y, size.z));
+		const float invScale = maxSide > 0 ? 1.0f / maxSide : 1.0f;
+		std::vector<ew::Vec3> positions(numVertices);
+		for (size_t i = 0; i < numVertices; i++)
+			positions[i] = (meshData.vertices[i].pos - meshData.bounds.min) * invScale;
+
+		//remap[v]: canonical vertex with the same position. wedge[v]: next vertex with the same position (circular)
+		std::vector<unsigned int> remap(numVertices);
+		std::vector<unsigned int> wedge(numVertices);
+		{
+			std::vector<unsigned int> order(numVertices);
+			for (size_t i = 0; i < numVertices; i++)
+				order[i] = (unsigned int)i;
+			const Vertex* vertices = meshData.vertices.data();
+			std::sort(order.begin(), order.end(), [vertices](unsigned int a, unsigned int b) {
+				const int c = memcmp(&vertices[a].pos, &vertices[b].pos, sizeof(ew::Vec3));
+				return c < 0 || (c == 0 && a < b);
+			});
+			for (size_t begin = 0; begin < numVertices;) {
+				size_t end = begin + 1;
+				while (end < numVertices && memcmp(&vertices[order[begin]].pos, &vertices[order[end]].pos, sizeof(ew::Vec3)) == 0)
+					end++;
+				for (size_t i = begin; i < end; i++) {
+					remap[order[i]] = order[begin];
+					wedge[order[i]] = order[i + 1 < end ? i + 1 : begin];
+				}
+				begin = end;
+			}
+		}
+
+		std::vector<unsigned int> adjacencyOffsets, adjacentTriangles;
+		detail::buildTriangleAdjacency(indices, numVertices, adjacencyOffsets, adjacentTriangles);
+		//True if some triangle has the directed edge a->b. With positions set, compares positions instead of vertices
+		auto hasEdge = [&](unsigned int a, unsigned int b, bool positions) {
+			unsigned int v = a;
+			do {
+				for (unsigned int t = adjacencyOffsets[v]; t < adjacencyOffsets[v + 1]; t++) {
+					const unsigned int* tri = &indices[adjacentTriangles[t] * 3];
+					const int corner = tri[0] == v ? 0 : tri[1] == v ? 1 : 2;
+					const unsigned int next = tri[(corner + 1) % 3];
+					if (positions ? remap[next] == remap[b] : next == b)
+						return true;
+				}
+				v = positions ? wedge[v] : a;
+			} while (v != a);
+			return false;
+		};
+
+		//Open edges: directed edges without a twin. loop[v] follows v's open edge, loopBack[v] leads into it
+		const unsigned int NONE = ~0u;
+		std::vector<unsigned int> loop(numVertices, NONE), loopBack(numVertices, NONE);
+		std::vector<unsigned char> openOut(numVertices, 0), openIn(numVertices, 0);
+		std::vector<Quadric> quadrics(numVertices);
+		for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+			const unsigned int tri[3] = { indices[i], indices[i + 1], indices[i + 2] };
+			const ew::Vec3 n = triangleNormal(positions[tri[0]], positions[tri[1]], positions[tri[2]]);
+			const float doubleArea = ew::Magnitude(n);
+			if (doubleArea <= 0)
+				continue;
+			const ew::Vec3 normal = n / doubleArea;
+			const float d = -ew::Dot(normal, positions[tri[0]]);
+			for (int c = 0; c < 3; c++)
+				quadrics[remap[tri[c]]].addPlane(normal, d, doubleArea * 0.5f);
+
+			for (int c = 0; c < 3; c++) {
+				const unsigned int a = tri[c], b = tri[(c + 1) % 3];
+				if (hasEdge(b, a, false))
+					continue;
+				loop[a] = b;
+				loopBack[b] = a;
+				openOut[a]++;
+				openIn[b]++;
+				//Keep the edge in place with a plane through it, perpendicular to the triangle
+				const bool border = !hasEdge(b, a, true);
+				const ew::Vec3 edge = positions[b] - positions[a];
+				const float length = ew::Magnitude(edge);
+				if (length <= 0)
+					continue;
+				const ew::Vec3 edgeNormal = ew::Normalize(ew::Cross(edge, normal));
+				const float edgeD = -ew::Dot(edgeNormal, positions[a]);
+				const float w = length * length * (border ? BORDER_WEIGHT : SEAM_WEIGHT);
+				quadrics[remap[a]].addPlane(edgeNormal, edgeD, w);
+				quadrics[remap[b]].addPlane(edgeNormal, edgeD, w);
+			}
+		}
+
+		std::vector<unsigned char> kinds(numVertices, KIND_LOCKED);
+		for (size_t i = 0; i < numVertices; i++) {
+			if (remap[i] != i)
+				continue;
+			const unsigned int w0 = (unsigned int)i;
+			const unsigned int w1 = wedge[w0];
+			unsigned char kind = KIND_LOCKED;
+			if (w1 == w0) {
+				if (openOut[w0] == 0 && openIn[w0] == 0)
+					kind = KIND_MANIFOLD;
+				else if (openOut[w0] == 1 && openIn[w0] == 1 && !hasEdge(loop[w0], w0, true) && !hasEdge(w0, loopBack[w0], true))
+					kind = KIND_BORDER;
+			}
+			else if (wedge[w1] == w0) {
+				//Each half has one open edge in and out, and across the seam the positions are connected
+				const bool halvesOpen = openOut[w0] == 1 && openIn[w0] == 1 && openOut[w1] == 1 && openIn[w1] == 1;
+				if (halvesOpen && hasEdge(loop[w0], w0, true) && hasEdge(loop[w1], w1, true))
+					kind = KIND_SEAM;
+			}
+			unsigned int v = w0;
+			do {
+				kinds[v] = kind;
+				v = wedge[v];
+			} while (v != w0);
+		}
+
+		//True if position to is the next or previous position along from's border or seam
+		auto isAlongLoop = [&](unsigned int from, unsigned int to) {
+			unsigned int v = from;
+			do {
+				const bool next = loop[v] != NONE && remap[loop[v]] == to;
+				const bool previous = loopBack[v] != NONE && remap[loopBack[v]] == to;
+				if (!next && !previous)
+					return false;
+				v = wedge[v];
+			} while (v != from);
+			return true;
+		};
+		auto canCollapse = [&](unsigned int from, unsigned int to) {
+			switch (kinds[from]) {
+			case KIND_MANIFOLD:
+				return true;
+			case KIND_BORDER:
+			case KIND_SEAM:
+				return isAlongLoop(from, to);
+			default:
+				return false;
+			}
+		};
+		auto collapseError = [&](unsigned int from, unsigned int to, unsigned int fromVertex, unsigned int toVertex) {
+			Quadric q = quadrics[from];
+			q.add(quadrics[to]);
+			const ew::Vec3 dn = meshData.vertices[fromVertex].normal - meshData.vertices[toVertex].normal;
+			return q.evaluate(positions[to]) + NORMAL_WEIGHT * ew::Dot(dn, dn);
+		};
+
+		std::vector<Collapse> collapses;
+		std::vector<unsigned int> vertexRemap(numVertices);
+		std::vector<unsigned char> locked(numVertices);
+		std::vector<unsigned int> targets;
+		float resultError = 0;
+		const float maxErrorSquared = maxError < sqrtf(FLT_MAX) ? maxError * maxError : FLT_MAX;
+
+		bool firstPass = true;
+		while (indices.size() > targetIndices) {
+			if (!firstPass)
+				detail::buildTriangleAdjacency(indices, numVertices, adjacencyOffsets, adjacentTriangles);
+			firstPass = false;
+
+			//Rank collapses. Each undirected edge is considered once, in its cheaper allowed direction
+			collapses.clear();
+			for (size_t i = 0; i < indices.size(); i += 3) {
+				for (int c = 0; c < 3; c++) {
+					const unsigned int a = indices[i + c], b = indices[i + (c + 1) % 3];
+					const unsigned int pa = remap[a], pb = remap[b];
+					if (pa == pb || (pa > pb && hasEdge(b, a, false)))
+						continue;
+					const bool ab = canCollapse(pa, pb), ba = canCollapse(pb, pa);
+					if (!ab && !ba)
+						continue;
+					const float errorAB = ab ? collapseError(pa, pb, a, b) : FLT_MAX;
+					const float errorBA = ba ? collapseError(pb, pa, b, a) : FLT_MAX;
+					if (errorAB <= errorBA)
+						collapses.push_back({ pa, pb, errorAB });
+					else
+						collapses.push_back({ pb, pa, errorBA });
+				}
+			}
+			if (collapses.empty())
+				break;
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+			//About two triangles go per collapse. Only take collapses up to a little past the cheapest ones that would reach the target,
+			//the rest are ranked again next pass with updated quadrics
+			const size_t trianglesToRemove = (indices.size() - targetIndices) / 3;
+			const size_t goal = std::min(collapses.size() - 1, (trianglesToRemove + 1) / 2);
+			const float passLimit = std::min(collapses[goal].error * 1.5f + 1e-12f, maxErrorSquared);
+
+			for (size_t i = 0; i < numVertices; i++)
+				vertexRemap[i] = (unsigned int)i;
+			std::fill(locked.begin(), locked.end(), 0);
+			size_t removed = 0;
+			size_t numCollapses = 0;
+			for (const Collapse& collapse : collapses) {
+				if (collapse.error > passLimit || removed >= trianglesToRemove)
+					break;
+				if (locked[collapse.from] || locked[collapse.to])
+					continue;
+
+				//Match each wedge of from with the wedge of to that it shares a triangle with, and check the triangles that move
+				targets.clear();
+				bool valid = true;
+				size_t degenerate = 0;
+				unsigned int w = collapse.from;
+				do {
+					unsigned int target = NONE;
+					for (unsigned int t = adjacencyOffsets[w]; t < adjacencyOffsets[w + 1] && valid; t++) {
+						const unsigned int* tri = &indices[adjacentTriangles[t] * 3];
+						const int corner = tri[0] == w ? 0 : tri[1] == w ? 1 : 2;
+						const unsigned int b = tri[(corner + 1) % 3], c = tri[(corner + 2) % 3];
+						if (remap[b] == collapse.to || remap[c] == collapse.to) {
+							target = remap[b] == collapse.to ? b : c;
+							degenerate++;
+							continue;
+						}
+						const ew::Vec3 before = triangleNormal(positions[w], positions[b], positions[c]);
+						const ew::Vec3 after = triangleNormal(positions[collapse.to], positions[b], positions[c]);
+						const float lengths = ew::Magnitude(before) * ew::Magnitude(after);
+						if (lengths <= 0 || ew::Dot(before, after) < MIN_NORMAL_COS * lengths)
+							valid = false;
+					}
+					if (target == NONE)
+						valid = false;
+					targets.push_back(target);
+					w = wedge[w];
+				} while (w != collapse.from && valid);
+				if (!valid)
+					continue;
+
+				//Lock the whole neighborhood so later collapses this pass see current geometry
+				w = collapse.from;
+				size_t wedgeIndex = 0;
+				do {
+					vertexRemap[w] = targets[wedgeIndex++];
+					//Splice w out of its border/seam loop
+					if (loop[w] != NONE && remap[loop[w]] == collapse.to)
+						loopBack[loop[w]] = loopBack[w];
+					if (loopBack[w] != NONE && remap[loopBack[w]] == collapse.to)
+						loop[loopBack[w]] = loop[w];
+					for (unsigned int t = adjacencyOffsets[w]; t < adjacencyOffsets[w + 1]; t++) {
+						const unsigned int* tri = &indices[adjacentTriangles[t] * 3];
+						for (int c = 0; c < 3; c++)
+							locked[remap[tri[c]]] = 1;
+					}
+					w = wedge[w];
+				} while (w != collapse.from);
+				locked[collapse.to] = 1;
+				quadrics[collapse.to].add(quadrics[collapse.from]);
+				resultError = std::max(resultError, collapse.error);
+				removed += degenerate;
+				numCollapses++;
+			}
+			if (numCollapses == 0)
+				break;
+
+			//Apply the pass and drop triangles that collapsed to a line
+			size_t write = 0;
+			for (size_t i = 0; i < indices.size(); i += 3) {
+				const unsigned int a = vertexRemap[indices[i]], b = vertexRemap[indices[i + 1]], c = vertexRemap[indices[i + 2]];
+				if (remap[a] == remap[b] || remap[b] == remap[c] || remap[c] == remap[a])
+					continue;
+				indices[write++] = a;
+				indices[write++] = b;
+				indices[write++] = c;
+			}
+			indices.resize(write);
+			for (size_t i = 0; i < numVertices; i++) {
+				if (loop[i] != NONE)
+					loop[i] = vertexRemap[loop[i]];
+				if (loopBack[i] != NONE)
+					loopBack[i] = vertexRemap[loopBack[i]];
+			}
+			report.trianglesAfter = indices.size() / 3;
+		}
+
+		//Remove unreferenced vertices, keeping the original order
+		std::vector<unsigned int> newIndex(numVertices, NONE);
+		for (unsigned int v : indices)
+			newIndex[v] = 0;
+		unsigned int numUsed = 0;
+		for (size_t i = 0; i < numVertices; i++) {
+			if (newIndex[i] == NONE)
+				continue;
+			newIndex[i] = numUsed;
+			meshData.vertices[numUsed++] = meshData.vertices[i];
+		}
+		meshData.vertices.resize(numUsed);
+		for (unsigned int& v : indices)
+			v = newIndex[v];
+		computeBounds(meshData);
+
+		report.trianglesAfter = indices.size() / 3;
+		report.error = sqrtf(resultError);
+		return report;
+	}
+
+	/// <summary>
+	/// Builds LOD levels by repeatedly simplifying the previous level. Later levels are cheaper to make this way,
+	/// and the levels nest: a vertex missing from one level is missing from all coarser ones.
+	/// </summary>
+	/// <param name="ratios">Triangle ratio of each level after the first, relative to meshData</param>
+	/// <returns>ratios.size() + 1 levels, finest first</returns>
+	std::vector<MeshData> createLodChain(const MeshData& meshData, const std::vector<float>& ratios)
+	{
+		std::vector<MeshData> lods;
+		lods.reserve(ratios.size() + 1);
+		lods.push_back(meshData);
+		const size_t numTriangles = meshData.indices.size() / 3;
+		for (float ratio : ratios) {
+			MeshData lod = lods.back();
+			const size_t current = lod.indices.size() / 3;
+			if (current > 0)
+				simplifyMesh(lod, (float)(ratio * numTriangles) / current);
+			lods.push_back(std::move(lod));
+		}
+		return lods;
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+
+//Mesh simplification and LOD chain generation for MeshData.
+//Simplification removes triangles with edge collapses ordered by quadric error (Garland and Heckbert 1997).
+//Collapses move a vertex onto a neighbor, so remaining vertices keep their exact position, normal and uv.
+namespace ew {
+	struct SimplifyReport {
+		size_t trianglesBefore = 0;
+		size_t trianglesAfter = 0;
+		//Largest collapse error as a distance, relative to the largest side of the mesh bounds
+		float error = 0;
+	};
+
+	//Collapses edges until at most targetRatio of the triangles are left, or no collapse stays under maxError
+	//(relative like SimplifyReport::error). Unused vertices are removed.
+	//Open borders and uv/normal seams (vertices split at the same position) are only collapsed along themselves,
+	//so their outline and both sides of a seam stay intact. Collapses that would flip or strongly tilt a triangle
+	//are rejected, which keeps the existing normals valid for the simplified surface.
+	SimplifyReport simplifyMesh(MeshData& meshData, float targetRatio, float maxError = FLT_MAX);
+
+	//Returns meshData followed by one simplified copy per ratio (relative to meshData's triangle count).
+	//Ratios should be decreasing. Each level is simplified from the previous one.
+	std::vector<MeshData> createLodChain(const MeshData& meshData, const std::vector<float>& ratios = { 0.5f, 0.25f, 0.1f });
+}
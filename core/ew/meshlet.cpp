@@ -0,0 +1,225 @@
+#include "meshlet.h"
+#include "meshOptimize.h"
+#include <algorithm>
+#include <math.h>
+#include "ewMath/transformations.h"
+
+namespace ew {
+	/// <summary>
+	/// Greedy growth. A meshlet starts from the first unused triangle, then repeatedly takes the neighboring triangle
+	/// that adds the fewest new vertices, breaking ties by how closely it faces the meshlet's average normal and how
+	/// close it is to the meshlet's center. Tight normal cones make back face culling effective, compact clusters make tight spheres.
+	/// </summary>
+	/// <param name="meshData">Indices are reordered in place</param>
+	/// <param name="maxVertices">Vertex limit per meshlet</param>
+	/// <param name="maxTriangles">Triangle limit per meshlet</param>
+	/// <returns>Meshlets in index buffer order</returns>
+	std::vector<Meshlet> buildMeshlets(MeshData& meshData, size_t maxVertices, size_t maxTriangles)
+	{
+		std::vector<Meshlet> meshlets;
+		const std::vector<unsigned int>& indices = meshData.indices;
+		const size_t numVertices = meshData.vertices.size();
+		const size_t numTriangles = indices.size() / 3;
+		if (numTriangles == 0 || maxVertices < 3 || maxTriangles == 0)
+			return meshlets;
+
+		std::vector<unsigned int> adjacencyOffsets, adjacentTriangles;
+		detail::buildTriangleAdjacency(indices, numVertices, adjacencyOffsets, adjacentTriangles);
+
+		std::vector<ew::Vec3> normals(numTriangles);
+		std::vector<ew::Vec3> centroids(numTriangles);
+		float totalArea = 0;
+		for (size_t t = 0; t < numTriangles; t++) {
+			const ew::Vec3& a = meshData.vertices[indices[t * 3]].pos;
+			const ew::Vec3& b = meshData.vertices[indices[t * 3 + 1]].pos;
+			const ew::Vec3& c = meshData.vertices[indices[t * 3 + 2]].pos;
+			const ew::Vec3 n = ew::Cross(b - a, c - a);
+			const float length = ew::Magnitude(n);
+			normals[t] = length > 0 ? n / length : ew::Vec3(0);
+			centroids[t] = (a + b + c) / 3.0f;
+			totalArea += length * 0.5f;
+		}
+		//Roughly the edge length of an average triangle. Meshlet radius grows with it times sqrt(triangles)
+		const float typicalEdge = fmaxf(sqrtf(2.0f * totalArea / numTriangles), 1e-20f);
+
+		const unsigned int NONE = ~0u;
+		std::vector<unsigned char> emitted(numTriangles, 0);
+		std::vector<unsigned int> vertexMeshlet(numVertices, NONE); //Meshlet the vertex was last added to
+		std::vector<unsigned int> meshletVertices;
+		std::vector<unsigned int> meshletTriangles;
+		std::vector<unsigned int> candidates;
+		std::vector<unsigned int> output;
+		output.reserve(numTriangles * 3);
+		size_t scan = 0;
+
+		while (true) {
+			while (scan < numTriangles && emitted[scan])
+				scan++;
+			if (scan == numTriangles)
+				break;
+
+			const unsigned int id = (unsigned int)meshlets.size();
+			Meshlet meshlet;
+			meshlet.firstIndex = (unsigned int)output.size();
+			meshletVertices.clear();
+			meshletTriangles.clear();
+			candidates.clear();
+			ew::Vec3 normalSum(0), centroidSum(0);
+
+			unsigned int next = (unsigned int)scan;
+			while (next != NONE) {
+				emitted[next] = 1;
+				meshletTriangles.push_back(next);
+				for (int c = 0; c < 3; c++) {
+					const unsigned int v = indices[next * 3 + c];
+					output.push_back(v);
+					if (vertexMeshlet[v] == id)
+						continue;
+					vertexMeshlet[v] = id;
+					meshletVertices.push_back(v);
+					for (unsigned int i = adjacencyOffsets[v]; i < adjacencyOffsets[v + 1]; i++) {
+						if (!emitted[adjacentTriangles[i]])
+							candidates.push_back(adjacentTriangles[i]);
+					}
+				}
+				normalSum += normals[next];
+				centroidSum += centroids[next];
+				if (meshletTriangles.size() == maxTriangles)
+					break;
+
+				const float normalLength = ew::Magnitude(normalSum);
+				const ew::Vec3 averageNormal = normalLength > 0 ? normalSum / normalLength : ew::Vec3(0);
+				const ew::Vec3 center = centroidSum / (float)meshletTriangles.size();
+				const float expectedRadius = typicalEdge * sqrtf((float)meshletTriangles.size());
+
+				next = NONE;
+				float bestScore = 0;
+				size_t write = 0;
+				for (size_t i = 0; i < candidates.size(); i++) {
+					const unsigned int t = candidates[i];
+					if (emitted[t])
+						continue;
+					candidates[write++] = t;
+					unsigned int newVertices = 0;
+					for (int c = 0; c < 3; c++)
+						newVertices += vertexMeshlet[indices[t * 3 + c]] != id;
+					if (meshletVertices.size() + newVertices > maxVertices)
+						continue;
+					const float facing = 1.0f - ew::Dot(normals[t], averageNormal);
+					const float distance = ew::Magnitude(centroids[t] - center) / expectedRadius;
+					const float score = newVertices + facing + 0.5f * distance;
+					if (next == NONE || score < bestScore) {
+						next = t;
+						bestScore = score;
+					}
+				}
+				candidates.resize(write);
+			}
+			meshlet.numIndices = (unsigned int)(output.size() - meshlet.firstIndex);
+			meshlet.numVertices = (unsigned int)meshletVertices.size();
+
+			//Sphere centered on the box around the vertices
+			ew::Vec3 min = meshData.vertices[meshletVertices[0]].pos, max = min;
+			for (unsigned int v : meshletVertices) {
+				const ew::Vec3& p = meshData.vertices[v].pos;
+				min = ew::Vec3(fminf(min.x, p.x), fminf(min.y, p.y), fminf(min.z, p.z));
+				max = ew::Vec3(fmaxf(max.x, p.x), fmaxf(max.y, p.y), fmaxf(max.z, p.z));
+			}
+			meshlet.center = (min + max) * 0.5f;
+			float radiusSquared = 0;
+			for (unsigned int v : meshletVertices) {
+				const ew::Vec3 d = meshData.vertices[v].pos - meshlet.center;
+				radiusSquared = fmaxf(radiusSquared, ew::Dot(d, d));
+			}
+			meshlet.radius = sqrtf(radiusSquared);
+
+			//Cone around the average normal. The apex is pulled back far enough that every triangle plane is in front of it,
+			//so a viewer inside the cone (measured from the apex) sees only back faces
+			const float normalLength = ew::Magnitude(normalSum);
+			if (normalLength > 0) {
+				meshlet.coneAxis = normalSum / normalLength;
+				float minDot = 1.0f;
+				for (unsigned int t : meshletTriangles)
+					minDot = fminf(minDot, ew::Dot(normals[t], meshlet.coneAxis));
+				//A cone wider than a hemisphere can always be seen from the front
+				if (minDot > 0) {
+					float maxT = 0;
+					for (unsigned int t : meshletTriangles) {
+						const ew::Vec3 toCenter = meshlet.center - meshData.vertices[indices[t * 3]].pos;
+						const float dn = ew::Dot(normals[t], meshlet.coneAxis);
+						if (dn > 0)
+							maxT = fmaxf(maxT, ew::Dot(toCenter, normals[t]) / dn);
+					}
+					meshlet.coneApex = meshlet.center - meshlet.coneAxis * maxT;
+					meshlet.coneCutoff = sqrtf(1.0f - minDot * minDot);
+				}
+			}
+			meshlets.push_back(meshlet);
+		}
+
+		meshData.indices.swap(output);
+		return meshlets;
+	}
+
+	/// <summary>
+	/// The frustum and camera are moved into mesh space once, so meshlet data is used as is.
+	/// </summary>
+	/// <param name="viewProjection">Camera projection * view</param>
+	/// <param name="model">Mesh to world</param>
+	/// <param name="cameraPosition">World space</param>
+	/// <param name="visible">One per meshlet</param>
+	/// <returns></returns>
+	MeshletCullStats cullMeshlets(const std::vector<Meshlet>& meshlets, const ew::Mat4& viewProjection, const ew::Mat4& model,
+		const ew::Vec3& cameraPosition, unsigned char* visible)
+	{
+		MeshletCullStats stats;
+		const Frustum frustum = ExtractFrustum(viewProjection * model);
+		const ew::Vec4 eye = ew::InverseAffine(model) * ew::Vec4(cameraPosition, 1.0f);
+		const ew::Vec3 meshEye(eye.x, eye.y, eye.z);
+		for (size_t i = 0; i < meshlets.size(); i++) {
+			const Meshlet& meshlet = meshlets[i];
+			visible[i] = 0;
+			if (!IsSphereVisible(frustum, meshlet.center, meshlet.radius)) {
+				stats.frustumCulled++;
+				continue;
+			}
+			if (meshlet.coneCutoff <= 1.0f) {
+				const ew::Vec3 view = meshlet.coneApex - meshEye;
+				const float length = ew::Magnitude(view);
+				if (length > 0 && ew::Dot(view, meshlet.coneAxis) >= meshlet.coneCutoff * length) {
+					stats.backfaceCulled++;
+					continue;
+				}
+			}
+			visible[i] = 1;
+			stats.visible++;
+		}
+		return stats;
+	}
+	size_t buildMeshletCommands(const std::vector<Meshlet>& meshlets, const unsigned char* visible, std::vector<DrawElementsIndirectCommand>& commands)
+	{
+		commands.clear();
+		for (size_t i = 0; i < meshlets.size(); i++) {
+			if (!visible[i])
+				continue;
+			const Meshlet& meshlet = meshlets[i];
+			if (!commands.empty() && commands.back().firstIndex + commands.back().count == meshlet.firstIndex) {
+				commands.back().count += meshlet.numIndices;
+				continue;
+			}
+			commands.push_back({ meshlet.numIndices, 1, meshlet.firstIndex, 0, 0 });
+		}
+		return commands.size();
+	}
+	size_t buildMeshletIndices(const MeshData& meshData, const std::vector<Meshlet>& meshlets, const unsigned char* visible, std::vector<unsigned int>& indices)
+	{
+		const size_t first = indices.size();
+		for (size_t i = 0; i < meshlets.size(); i++) {
+			if (!visible[i])
+				continue;
+			const unsigned int* begin = meshData.indices.data() + meshlets[i].firstIndex;
+			indices.insert(indices.end(), begin, begin + meshlets[i].numIndices);
+		}
+		return indices.size() - first;
+	}
+}
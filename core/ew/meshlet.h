@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+#include "ewMath/frustum.h"
+
+//Meshlets: small clusters of neighboring triangles that can be culled on their own.
+//buildMeshlets reorders the index buffer so every meshlet is one contiguous index range,
+//so culled meshlets can be drawn straight from the same Mesh with indirect commands.
+namespace ew {
+	struct Meshlet {
+		unsigned int firstIndex = 0; //Range in MeshData::indices
+		unsigned int numIndices = 0;
+		unsigned int numVertices = 0; //Unique vertices referenced
+		//Bounding sphere
+		ew::Vec3 center;
+		float radius = 0;
+		//Normal cone. Every triangle faces away from a viewer at p when
+		//Dot(Normalize(coneApex - p), coneAxis) >= coneCutoff. coneCutoff > 1 means it can never be back facing
+		ew::Vec3 coneApex;
+		ew::Vec3 coneAxis;
+		float coneCutoff = 2.0f;
+	};
+
+	//Splits meshData into meshlets of at most maxVertices vertices and maxTriangles triangles.
+	//Triangles are grown from neighbors that share vertices and face the same way, which keeps spheres and cones tight.
+	//meshData.indices is reordered, vertices are unchanged.
+	std::vector<Meshlet> buildMeshlets(MeshData& meshData, size_t maxVertices = 64, size_t maxTriangles = 124);
+
+	struct MeshletCullStats {
+		size_t visible = 0;
+		size_t frustumCulled = 0;
+		size_t backfaceCulled = 0;
+	};
+
+	//Frustum and normal cone test for every meshlet. visible[i] is set to 1 or 0.
+	//model places the mesh in the world; it should not have non-uniform scale (cones are tested in mesh space).
+	MeshletCullStats cullMeshlets(const std::vector<Meshlet>& meshlets, const ew::Mat4& viewProjection, const ew::Mat4& model,
+		const ew::Vec3& cameraPosition, unsigned char* visible);
+
+	//One indirect command per run of visible meshlets (neighbors in the index buffer are merged), for Mesh::drawIndirect.
+	//Returns the number of commands
+	size_t buildMeshletCommands(const std::vector<Meshlet>& meshlets, const unsigned char* visible, std::vector<DrawElementsIndirectCommand>& commands);
+	//Appends the indices of visible meshlets to indices, for uploading as a compacted index buffer.
+	//Returns the number of indices written
+	size_t buildMeshletIndices(const MeshData& meshData, const std::vector<Meshlet>& meshlets, const unsigned char* visible, std::vector<unsigned int>& indices);
+}
@@ -5,18 +5,40 @@
 
 #include "procGen.h"
 #include <stdlib.h>
+#include <stdint.h>
+#include <vector>
 
 namespace ew {
+	//Normal and U/V axes of one cube face
+	struct CubeFace {
+		ew::Vec3 normal;
+		ew::Vec3 u;
+		ew::Vec3 v;
+	};
+	static constexpr CubeFace makeCubeFace(ew::Vec3 normal) {
+		const ew::Vec3 a = ew::Vec3(normal.z, normal.x, normal.y); //U axis
+		return CubeFace{ normal, a, ew::Cross(normal, a) }; //V axis
+	}
+	//Face bases are folded at compile time
+	static constexpr CubeFace CUBE_FACES[6] = {
+		makeCubeFace(ew::Vec3{ +0.0f,+0.0f,+1.0f }), //Front
+		makeCubeFace(ew::Vec3{ +1.0f,+0.0f,+0.0f }), //Right
+		makeCubeFace(ew::Vec3{ +0.0f,+1.0f,+0.0f }), //Top
+		makeCubeFace(ew::Vec3{ -1.0f,+0.0f,+0.0f }), //Left
+		makeCubeFace(ew::Vec3{ +0.0f,-1.0f,+0.0f }), //Bottom
+		makeCubeFace(ew::Vec3{ +0.0f,+0.0f,-1.0f }), //Back
+	};
 	/// <summary>
 	/// Helper function for createCube. Note that this is not meant to be used standalone
 	/// </summary>
-	/// <param name="normal">Normal direction of the face</param>
+	/// <param name="face">Normal and U/V axes of the face</param>
 	/// <param name="size">Width/height of the face</param>
 	/// <param name="mesh">MeshData struct to fill</param>
-	static void createCubeFace(ew::Vec3 normal, float size, MeshData* mesh) {
+	static void createCubeFace(const CubeFace& face, float size, MeshData* mesh) {
 		unsigned int startVertex = mesh->vertices.size();
-		ew::Vec3 a = ew::Vec3(normal.z, normal.x, normal.y); //U axis
-		ew::Vec3 b = ew::Cross(normal, a); //V axis
+		const ew::Vec3& normal = face.normal;
+		const ew::Vec3& a = face.u;
+		const ew::Vec3& b = face.v;
 		for (int i = 0; i < 4; i++)
 		{
 			int col = i % 2;
@@ -49,12 +71,10 @@ namespace ew {
 		MeshData mesh;
 		mesh.vertices.reserve(24); //6 x 4 vertices
 		mesh.indices.reserve(36); //6 x 6 indices
-		createCubeFace(ew::Vec3{ +0.0f,+0.0f,+1.0f }, size, &mesh); //Front
-		createCubeFace(ew::Vec3{ +1.0f,+0.0f,+0.0f }, size, &mesh); //Right
-		createCubeFace(ew::Vec3{ +0.0f,+1.0f,+0.0f }, size, &mesh); //Top
-		createCubeFace(ew::Vec3{ -1.0f,+0.0f,+0.0f }, size, &mesh); //Left
-		createCubeFace(ew::Vec3{ +0.0f,-1.0f,+0.0f }, size, &mesh); //Bottom
-		createCubeFace(ew::Vec3{ +0.0f,+0.0f,-1.0f }, size, &mesh); //Back
+		for (const CubeFace& face : CUBE_FACES) {
+			createCubeFace(face, size, &mesh);
+		}
+		mesh.bounds = Bounds(ew::Vec3(-size * 0.5f), ew::Vec3(size * 0.5f));
 		return mesh;
 	}
 	MeshData createPlane(float width, float height, int subdivisions)
@@ -90,6 +110,7 @@ namespace ew {
 				mesh.indices.push_back(start);
 			}
 		}
+		mesh.bounds = Bounds(ew::Vec3(-width * 0.5f, 0, -height * 0.5f), ew::Vec3(width * 0.5f, 0, height * 0.5f));
 		return mesh;
 	}
 	MeshData createSphere(float radius, int subdivisions)
@@ -149,6 +170,8 @@ namespace ew {
 			mesh.indices.push_back(sideStart + i + 1);
 			mesh.indices.push_back(poleStart + i);
 		}
+		mesh.bounds = Bounds(ew::Vec3(-radius), ew::Vec3(radius));
+		mesh.bounds.radius = radius;
 		return mesh;
 	}
 	void createCylinderRing(MeshData* meshData, float radius, int subdivisions, float y, bool sideFacing) {
@@ -204,15 +227,15 @@ namespace ew {
 		{
 			int columns = subdivisions + 1;
 			//Top cap
-			for (size_t i = 0; i < columns; i++)
+			for (size_t i = 0; i < subdivisions; i++)
 			{
 				mesh.indices.push_back(0);
+				mesh.indices.push_back(i + 2);
 				mesh.indices.push_back(i + 1);
-				mesh.indices.push_back(i);
 			}
-			int sideStart = columns;
+			int sideStart = columns + 1;
 			//Sides
-			for (size_t i = 0; i < columns; i++)
+			for (size_t i = 0; i < subdivisions; i++)
 			{
 				int start = sideStart + i;
 				mesh.indices.push_back(start);
@@ -225,13 +248,135 @@ namespace ew {
 			//Bottom cap
 			int bottomIndex = mesh.vertices.size() - 1;
 			sideStart = bottomIndex - columns;
-			for (size_t i = 0; i < columns; i++)
+			for (size_t i = 0; i < subdivisions; i++)
 			{
 				mesh.indices.push_back(bottomIndex);
 				mesh.indices.push_back(sideStart + i);
 				mesh.indices.push_back(sideStart + i + 1);
 			}
 		}
+		mesh.bounds = Bounds(ew::Vec3(-radius, -height * 0.5f, -radius), ew::Vec3(radius, height * 0.5f, radius));
+		mesh.bounds.radius = sqrtf(radius * radius + height * height * 0.25f);
+		return mesh;
+	}
+	//Golden ratio icosahedron. Faces wind counter clockwise seen from outside
+	static const float ICOSAHEDRON_T = 1.6180339887f;
+	static const ew::Vec3 ICOSAHEDRON_VERTICES[12] = {
+		ew::Vec3(-1, ICOSAHEDRON_T, 0), ew::Vec3(1, ICOSAHEDRON_T, 0), ew::Vec3(-1, -ICOSAHEDRON_T, 0), ew::Vec3(1, -ICOSAHEDRON_T, 0),
+		ew::Vec3(0, -1, ICOSAHEDRON_T), ew::Vec3(0, 1, ICOSAHEDRON_T), ew::Vec3(0, -1, -ICOSAHEDRON_T), ew::Vec3(0, 1, -ICOSAHEDRON_T),
+		ew::Vec3(ICOSAHEDRON_T, 0, -1), ew::Vec3(ICOSAHEDRON_T, 0, 1), ew::Vec3(-ICOSAHEDRON_T, 0, -1), ew::Vec3(-ICOSAHEDRON_T, 0, 1)
+	};
+	static const unsigned int ICOSAHEDRON_INDICES[60] = {
+		0, 11, 5,  0, 5, 1,  0, 1, 7,  0, 7, 10,  0, 10, 11,
+		1, 5, 9,  5, 11, 4,  11, 10, 2,  10, 7, 6,  7, 1, 8,
+		3, 9, 4,  3, 4, 2,  3, 2, 6,  3, 6, 8,  3, 8, 9,
+		4, 9, 5,  2, 4, 11,  6, 2, 10,  8, 6, 7,  9, 8, 1
+	};
+	//Same mapping as createSphere: u goes around from +X towards +Z, v = 1 at the top
+	static ew::Vec2 sphereUV(const ew::Vec3& normal) {
+		float u = atan2f(normal.z, normal.x) / ew::TAU;
+		if (u < 0)
+			u += 1.0f;
+		const float v = 1.0f - acosf(ew::Clamp(normal.y, -1.0f, 1.0f)) / ew::PI;
+		return ew::Vec2(u, v);
+	}
+	/// <summary>
+	/// Creates a sphere by subdividing an icosahedron. Every level splits each triangle into 4, giving
+	/// 20 * 4^level triangles of nearly equal size, so detail is spread evenly instead of bunching at the poles.
+	/// Edge midpoints are looked up in a hash map keyed by the edge, so vertices shared by neighbouring triangles are created once.
+	/// </summary>
+	/// <param name="radius"></param>
+	/// <param name="level">Subdivision level. 0 is the icosahedron, each level quadruples the triangle count</param>
+	/// <param name="splitSeam">UVs wrap from 1 back to 0 at the seam. When true, the vertices of triangles crossing it are
+	/// duplicated with u + 1 so textures map without a smeared column. When false every vertex is shared</param>
+	/// <returns></returns>
+	MeshData createIcosphere(float radius, int level, bool splitSeam)
+	{
+		//Level 12 is already 335M triangles; beyond that indices would overflow
+		level = level < 0 ? 0 : (level > 12 ? 12 : level);
+		MeshData mesh;
+		//V = 10 * 4^level + 2, F = 20 * 4^level
+		const size_t numFaces = (size_t)20 << (2 * level);
+		const size_t numVertices = ((size_t)10 << (2 * level)) + 2;
+		std::vector<ew::Vec3> positions;
+		positions.reserve(numVertices);
+		for (const ew::Vec3& v : ICOSAHEDRON_VERTICES)
+			positions.push_back(ew::Normalize(v));
+		std::vector<unsigned int> indices(ICOSAHEDRON_INDICES, ICOSAHEDRON_INDICES + 60);
+		std::vector<unsigned int> subdivided;
+		subdivided.reserve(numFaces * 3);
+		//Open addressing hash map from edge (lower index << 32 | higher index) to its midpoint vertex
+		std::vector<uint64_t> edgeKeys;
+		std::vector<unsigned int> edgeMidpoints;
+
+		for (int l = 0; l < level; l++) {
+			//Each level has 3/2 as many edges as triangles. Keep the table at most half full
+			size_t capacity = 64;
+			while (capacity < indices.size())
+				capacity *= 2;
+			edgeKeys.assign(capacity, UINT64_MAX);
+			edgeMidpoints.resize(capacity);
+			auto midpoint = [&](unsigned int a, unsigned int b) {
+				const uint64_t key = a < b ? ((uint64_t)a << 32 | b) : ((uint64_t)b << 32 | a);
+				size_t slot = (size_t)((key * 0x9e3779b97f4a7c15ull) >> 32) & (capacity - 1);
+				while (edgeKeys[slot] != key) {
+					if (edgeKeys[slot] == UINT64_MAX) {
+						edgeKeys[slot] = key;
+						edgeMidpoints[slot] = (unsigned int)positions.size();
+						positions.push_back(ew::Normalize(positions[a] + positions[b]));
+						break;
+					}
+					slot = (slot + 1) & (capacity - 1);
+				}
+				return edgeMidpoints[slot];
+			};
+			subdivided.clear();
+			for (size_t i = 0; i < indices.size(); i += 3) {
+				const unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+				const unsigned int ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+				const unsigned int triangles[12] = { a, ab, ca,  b, bc, ab,  c, ca, bc,  ab, bc, ca };
+				subdivided.insert(subdivided.end(), triangles, triangles + 12);
+			}
+			indices.swap(subdivided);
+		}
+
+		//VERTICES
+		mesh.vertices.resize(positions.size());
+		for (size_t i = 0; i < positions.size(); i++) {
+			Vertex& v = mesh.vertices[i];
+			v.normal = positions[i];
+			v.pos = positions[i] * radius;
+			v.uv = sphereUV(positions[i]);
+		}
+
+		//INDICES
+		if (splitSeam) {
+			//A triangle spanning more than half the u range crosses the seam. Its vertices on the low side get
+			//a copy with u + 1, made once per vertex
+			std::vector<unsigned int> seamCopy(positions.size(), UINT32_MAX);
+			for (size_t i = 0; i < indices.size(); i += 3) {
+				const float u0 = mesh.vertices[indices[i]].uv.x;
+				const float u1 = mesh.vertices[indices[i + 1]].uv.x;
+				const float u2 = mesh.vertices[indices[i + 2]].uv.x;
+				if (fmaxf(u0, fmaxf(u1, u2)) - fminf(u0, fminf(u1, u2)) <= 0.5f)
+					continue;
+				for (size_t j = i; j < i + 3; j++) {
+					const unsigned int index = indices[j];
+					if (mesh.vertices[index].uv.x >= 0.5f)
+						continue;
+					if (seamCopy[index] == UINT32_MAX) {
+						Vertex copy = mesh.vertices[index];
+						copy.uv.x += 1.0f;
+						seamCopy[index] = (unsigned int)mesh.vertices.size();
+						mesh.vertices.push_back(copy);
+					}
+					indices[j] = seamCopy[index];
+				}
+			}
+		}
+		mesh.indices = std::move(indices);
+		mesh.bounds = Bounds(ew::Vec3(-radius), ew::Vec3(radius));
+		mesh.bounds.radius = radius;
 		return mesh;
 	}
 }
\ No newline at end of file
@@ -11,4 +11,6 @@ namespace ew {
 	MeshData createPlane(float width, float height, int subdivisions);
 	MeshData createSphere(float radius, int subdivisions);
 	MeshData createCylinder(float radius, float height, int subdivisions);
+	//20 * 4^level evenly sized triangles. splitSeam duplicates vertices along the u = 0/1 seam so UVs don't wrap across it
+	MeshData createIcosphere(float radius, int level, bool splitSeam = false);
 }
@@ -0,0 +1,320 @@
+#include "terrain.h"
+#include <math.h>
+#include <assert.h>
+#include <algorithm>
+#include "procGen.h"
+#include "ewMath/frustum.h"
+
+namespace ew {
+	static float lerp(float a, float b, float t)
+	{
+		return a + (b - a) * t;
+	}
+	static uint32_t hashCorner(int x, int z, uint32_t seed)
+	{
+		uint32_t h = (uint32_t)x * 0x8da6b343u ^ (uint32_t)z * 0xd8163841u ^ seed * 0xcb1ab31fu;
+		h ^= h >> 13;
+		h *= 0x85ebca6bu;
+		h ^= h >> 16;
+		return h;
+	}
+	//Perlin style gradient noise with 8 gradient directions
+	static float gradientNoise(float x, float z, uint32_t seed)
+	{
+		static const float GRADIENTS[8][2] = {
+			{ 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+			{ 0.7071f, 0.7071f }, { -0.7071f, 0.7071f }, { 0.7071f, -0.7071f }, { -0.7071f, -0.7071f }
+		};
+		const float fx = floorf(x), fz = floorf(z);
+		const int ix = (int)fx, iz = (int)fz;
+		const float dx = x - fx, dz = z - fz;
+		auto corner = [&](int cx, int cz) {
+			const float* g = GRADIENTS[hashCorner(ix + cx, iz + cz, seed) & 7];
+			return g[0] * (dx - cx) + g[1] * (dz - cz);
+		};
+		//Quintic fade keeps the second derivative continuous, so normals have no grid creases
+		const float u = dx * dx * dx * (dx * (dx * 6 - 15) + 10);
+		const float v = dz * dz * dz * (dz * (dz * 6 - 15) + 10);
+		const float bottom = lerp(corner(0, 0), corner(1, 0), u);
+		const float top = lerp(corner(0, 1), corner(1, 1), u);
+		return lerp(bottom, top, v) * 1.4142f;
+	}
+	/// <summary>
+	/// Sums octaves of gradient noise, each at twice the frequency and half the amplitude of the last.
+	/// </summary>
+	/// <param name="x"></param>
+	/// <param name="z"></param>
+	/// <param name="seed">Each seed gives an unrelated field</param>
+	/// <param name="octaves">Number of layers. More adds finer detail</param>
+	/// <returns></returns>
+	float TerrainNoise(float x, float z, uint32_t seed, int octaves)
+	{
+		float sum = 0, amplitude = 1, totalAmplitude = 0;
+		for (int o = 0; o < octaves; o++) {
+			sum += gradientNoise(x, z, seed + o * 0x9e3779b9u) * amplitude;
+			totalAmplitude += amplitude;
+			amplitude *= 0.5f;
+			x *= 2.0f;
+			z *= 2.0f;
+		}
+		return totalAmplitude > 0 ? sum / totalAmplitude : 0;
+	}
+
+	//Chunks next to each other along X and Z
+	enum ChunkEdge { EDGE_NORTH, EDGE_SOUTH, EDGE_WEST, EDGE_EAST, NUM_EDGES }; //+Z, -Z, -X, +X
+	static const int EDGE_OFFSETS[NUM_EDGES][2] = { { 0, 1 }, { 0, -1 }, { -1, 0 }, { 1, 0 } };
+
+	static uint64_t chunkKey(int x, int z)
+	{
+		return (uint64_t)(uint32_t)x << 32 | (uint32_t)z;
+	}
+	//4 bits each: the chunk's LOD, then the LOD of each neighbour (never finer than the chunk's own).
+	//The top bit keeps every variant nonzero
+	static uint32_t makeVariant(int lod, const int neighbourLods[NUM_EDGES])
+	{
+		uint32_t variant = 0x80000000u | (uint32_t)lod;
+		for (int e = 0; e < NUM_EDGES; e++)
+			variant |= (uint32_t)std::max(neighbourLods[e], lod) << (4 + 4 * e);
+		return variant;
+	}
+	static int variantLod(uint32_t variant, int edge = -1)
+	{
+		return (variant >> (edge < 0 ? 0 : 4 + 4 * edge)) & 15;
+	}
+
+	/// <summary>
+	/// Builds one chunk: a createPlane grid at the LOD's resolution, moved to the chunk and displaced by the height function.
+	/// World positions are computed from integer grid coordinates, so chunks sharing an edge sample exactly the same points.
+	/// Normals come from central differences at the full detail spacing, so they match across LODs too.
+	/// Vertices along an edge with a coarser neighbour are then put on the straight line between the neighbour's vertices.
+	/// </summary>
+	static MeshData generateChunk(int chunkX, int chunkZ, uint32_t variant, const TerrainSettings& settings, const std::function<float(float, float)>& height)
+	{
+		const int lod = variantLod(variant);
+		const int resolution = settings.chunkResolution >> lod;
+		const int step = 1 << lod; //In full detail grid cells
+		const float cellSize = settings.chunkSize / settings.chunkResolution;
+		const int columns = resolution + 1;
+
+		MeshData meshData = createPlane(settings.chunkSize, settings.chunkSize, resolution);
+		for (int row = 0; row <= resolution; row++) {
+			for (int col = 0; col <= resolution; col++) {
+				//createPlane puts row 0 at +Z and column 0 at -X
+				const int64_t gridX = (int64_t)chunkX * settings.chunkResolution + col * step;
+				const int64_t gridZ = (int64_t)(chunkZ + 1) * settings.chunkResolution - row * step;
+				const float x = gridX * cellSize;
+				const float z = gridZ * cellSize;
+				Vertex& v = meshData.vertices[row * columns + col];
+				v.pos = ew::Vec3(x, height(x, z), z);
+				const float dx = height(x - cellSize, z) - height(x + cellSize, z);
+				const float dz = height(x, z - cellSize) - height(x, z + cellSize);
+				v.normal = ew::Normalize(ew::Vec3(dx, 2.0f * cellSize, dz));
+			}
+		}
+
+		for (int e = 0; e < NUM_EDGES; e++) {
+			const int neighbourLod = variantLod(variant, e);
+			if (neighbourLod <= lod)
+				continue;
+			const int span = 1 << (neighbourLod - lod); //Our vertices per neighbour edge segment
+			auto edgeVertex = [&](int k) -> Vertex& {
+				switch (e) {
+				case EDGE_NORTH: return meshData.vertices[k];
+				case EDGE_SOUTH: return meshData.vertices[resolution * columns + k];
+				case EDGE_WEST: return meshData.vertices[k * columns];
+				default: return meshData.vertices[k * columns + resolution];
+				}
+			};
+			for (int k = 0; k <= resolution; k++) {
+				const int offset = k % span;
+				if (offset == 0)
+					continue;
+				const float t = (float)offset / span;
+				edgeVertex(k).pos.y = lerp(edgeVertex(k - offset).pos.y, edgeVertex(k - offset + span).pos.y, t);
+			}
+		}
+		computeBounds(meshData);
+		return meshData;
+	}
+
+	Terrain::Terrain(const TerrainSettings& settings, std::function<float(float, float)> heightFunction)
+		:m_settings(settings), m_heightFunction(std::move(heightFunction)), m_results(std::make_shared<Results>()),
+		m_pool(settings.numThreads > 0 ? settings.numThreads + 1 : std::max(2u, std::thread::hardware_concurrency()))
+	{
+		//Every LOD needs a whole number of quads, and LODs are stored in 4 bits
+		m_settings.numLods = std::max(1, std::min(m_settings.numLods, 15));
+		const int minResolution = 1 << (m_settings.numLods - 1);
+		m_settings.chunkResolution = std::max(minResolution, m_settings.chunkResolution / minResolution * minResolution);
+		if (!m_heightFunction) {
+			const TerrainSettings s = m_settings;
+			m_heightFunction = [s](float x, float z) {
+				return TerrainNoise(x * s.noiseScale, z * s.noiseScale, s.seed, s.octaves) * s.heightScale;
+			};
+		}
+	}
+	Terrain::~Terrain()
+	{
+		//Queued generator tasks return without generating; m_pool then joins the running ones
+		m_results->cancelled = true;
+	}
+	size_t Terrain::estimateBytes(int lod)const
+	{
+		const size_t resolution = (size_t)(m_settings.chunkResolution >> lod);
+		return (resolution + 1) * (resolution + 1) * sizeof(Vertex) + resolution * resolution * 6 * sizeof(unsigned int);
+	}
+	void Terrain::requestChunk(int x, int z, uint32_t variant)
+	{
+		m_numPending++;
+		std::shared_ptr<Results> results = m_results;
+		const TerrainSettings settings = m_settings;
+		const std::function<float(float, float)> height = m_heightFunction;
+		m_pool.submit([=]() {
+			if (results->cancelled)
+				return;
+			GeneratedChunk chunk = { chunkKey(x, z), variant, generateChunk(x, z, variant, settings, height) };
+			std::lock_guard<std::mutex> lock(results->mutex);
+			results->chunks.push_back(std::move(chunk));
+		});
+	}
+	/// <summary>
+	/// 1. Takes finished chunks from the generators and uploads a few of them.
+	/// 2. Lists chunks within the view distance with the LOD for their distance, nearest first, up to the memory budget.
+	/// 3. Requests any chunk whose LOD or neighbour LODs differ from what is loaded or already requested.
+	/// 4. Unloads chunks that are no longer wanted once they are a chunk beyond the view distance, or right away if over budget.
+	/// </summary>
+	/// <param name="camera"></param>
+	void Terrain::update(const Camera& camera)
+	{
+		const float chunkSize = m_settings.chunkSize;
+
+		//Finished chunks. Results for chunks that were unloaded or re-requested since are dropped.
+		//A chunk stays pending until its result is uploaded, so it is not requested again while queued
+		std::vector<GeneratedChunk> finished;
+		{
+			std::lock_guard<std::mutex> lock(m_results->mutex);
+			finished.swap(m_results->chunks);
+		}
+		for (GeneratedChunk& generated : finished) {
+			m_numPending--;
+			auto found = m_chunks.find(generated.key);
+			if (found == m_chunks.end() || found->second.pendingVariant != generated.variant)
+				continue;
+			found->second.queuedVariant = generated.variant;
+			m_uploadQueue.push_back(std::move(generated));
+		}
+		const int maxUploads = std::max(1, m_settings.maxUploadsPerFrame);
+		size_t numTaken = 0;
+		for (int numUploads = 0; numTaken < m_uploadQueue.size() && numUploads < maxUploads; numTaken++) {
+			GeneratedChunk& generated = m_uploadQueue[numTaken];
+			auto found = m_chunks.find(generated.key);
+			if (found == m_chunks.end() || found->second.pendingVariant != generated.variant)
+				continue;
+			Chunk& chunk = found->second;
+			m_memoryUsage -= chunk.bytes;
+			m_numLoaded += chunk.loaded ? 0 : 1;
+			chunk.bytes = generated.meshData.vertices.size() * sizeof(Vertex) + generated.meshData.indices.size() * sizeof(unsigned int);
+			chunk.mesh.load(std::move(generated.meshData));
+			chunk.variant = generated.variant;
+			chunk.pendingVariant = 0;
+			chunk.queuedVariant = 0;
+			chunk.loaded = true;
+			m_memoryUsage += chunk.bytes;
+			numUploads++;
+		}
+		m_uploadQueue.erase(m_uploadQueue.begin(), m_uploadQueue.begin() + numTaken);
+
+		//Wanted chunks, by distance from the camera to the nearest point of the chunk (XZ only)
+		struct Wanted {
+			int x, z, lod;
+			float distance;
+		};
+		auto distanceTo = [&](int x, int z) {
+			const float dx = std::max(std::max(x * chunkSize - camera.position.x, camera.position.x - (x + 1) * chunkSize), 0.0f);
+			const float dz = std::max(std::max(z * chunkSize - camera.position.z, camera.position.z - (z + 1) * chunkSize), 0.0f);
+			return sqrtf(dx * dx + dz * dz);
+		};
+		std::vector<Wanted> wanted;
+		const int cameraX = (int)floorf(camera.position.x / chunkSize);
+		const int cameraZ = (int)floorf(camera.position.z / chunkSize);
+		//One extra ring for chunks exactly at the view distance past the camera's own chunk
+		const int range = (int)(m_settings.viewDistance / chunkSize) + 1;
+		for (int z = cameraZ - range; z <= cameraZ + range; z++) {
+			for (int x = cameraX - range; x <= cameraX + range; x++) {
+				const float distance = distanceTo(x, z);
+				if (distance > m_settings.viewDistance)
+					continue;
+				int lod = 0;
+				for (float limit = m_settings.lodDistance; distance >= limit && lod < m_settings.numLods - 1; limit *= 2)
+					lod++;
+				wanted.push_back({ x, z, lod, distance });
+			}
+		}
+		std::sort(wanted.begin(), wanted.end(), [](const Wanted& a, const Wanted& b) { return a.distance < b.distance; });
+		std::unordered_map<uint64_t, int> wantedLods;
+		size_t wantedBytes = 0;
+		for (const Wanted& w : wanted) {
+			wantedBytes += estimateBytes(w.lod);
+			if (wantedBytes > m_settings.memoryBudget)
+				break;
+			wantedLods[chunkKey(w.x, w.z)] = w.lod;
+		}
+
+		//Nearest first, with a few requests per generator thread in flight
+		const int maxPending = (int)m_pool.getNumThreads() * 2;
+		for (const Wanted& w : wanted) {
+			if (m_numPending >= maxPending)
+				break;
+			const uint64_t key = chunkKey(w.x, w.z);
+			if (wantedLods.find(key) == wantedLods.end())
+				break;
+			int neighbourLods[NUM_EDGES];
+			for (int e = 0; e < NUM_EDGES; e++) {
+				auto neighbour = wantedLods.find(chunkKey(w.x + EDGE_OFFSETS[e][0], w.z + EDGE_OFFSETS[e][1]));
+				neighbourLods[e] = neighbour != wantedLods.end() ? neighbour->second : w.lod;
+			}
+			const uint32_t variant = makeVariant(w.lod, neighbourLods);
+			Chunk& chunk = m_chunks[key];
+			if ((chunk.loaded && chunk.variant == variant) || chunk.pendingVariant == variant)
+				continue;
+			assert(chunk.queuedVariant != variant);
+			chunk.pendingVariant = variant;
+			chunk.queuedVariant = 0; //A queued result for another variant is now stale and gets dropped
+			requestChunk(w.x, w.z, variant);
+		}
+
+		//Unload chunks that are no longer wanted, farthest first
+		std::vector<std::pair<float, uint64_t>> unwanted;
+		for (const auto& entry : m_chunks) {
+			if (wantedLods.find(entry.first) == wantedLods.end()) {
+				const int x = (int)(int32_t)(entry.first >> 32), z = (int)(int32_t)(uint32_t)entry.first;
+				unwanted.push_back({ distanceTo(x, z), entry.first });
+			}
+		}
+		std::sort(unwanted.begin(), unwanted.end(), [](const std::pair<float, uint64_t>& a, const std::pair<float, uint64_t>& b) { return a.first > b.first; });
+		for (const auto& u : unwanted) {
+			Chunk& chunk = m_chunks[u.second];
+			const bool pastView = u.first > m_settings.viewDistance + chunkSize;
+			if (chunk.loaded && !pastView && m_memoryUsage <= m_settings.memoryBudget)
+				continue;
+			m_memoryUsage -= chunk.bytes;
+			m_numLoaded -= chunk.loaded ? 1 : 0;
+			m_chunks.erase(u.second);
+		}
+	}
+	int Terrain::draw(const ew::Mat4& viewProjection)const
+	{
+		const Frustum frustum = ExtractFrustum(viewProjection);
+		int numDrawn = 0;
+		for (const auto& entry : m_chunks) {
+			const Chunk& chunk = entry.second;
+			if (!chunk.loaded)
+				continue;
+			const Bounds& bounds = chunk.mesh.getBounds();
+			if (!IsAABBVisible(frustum, bounds.center, bounds.extents()))
+				continue;
+			chunk.mesh.draw();
+			numDrawn++;
+		}
+		return numDrawn;
+	}
+}
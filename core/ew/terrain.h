@@ -0,0 +1,94 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "mesh.h"
+#include "camera.h"
+#include "threadPool.h"
+
+namespace ew {
+	struct TerrainSettings {
+		uint32_t seed = 1;
+		float chunkSize = 32.0f; //World units per chunk side
+		int chunkResolution = 64; //Quads per chunk side at full detail. Must be divisible by 2^(numLods - 1)
+		int numLods = 4; //Each level halves the resolution
+		float lodDistance = 48.0f; //Full detail out to here. Every further level covers twice the distance of the previous
+		float viewDistance = 256.0f; //Chunks closer than this are loaded
+		size_t memoryBudget = 64 * 1024 * 1024; //GPU bytes for chunk meshes. Farthest chunks are skipped beyond it
+		int maxUploadsPerFrame = 4; //Finished chunks uploaded per update, to spread the cost over frames
+		unsigned int numThreads = 0; //Background generator threads. 0 = all hardware threads but one
+
+		//Default height function: fractal gradient noise
+		float heightScale = 24.0f;
+		float noiseScale = 1.0f / 128.0f; //Frequency of the first octave
+		int octaves = 5;
+	};
+
+	//Seedable fractal (fBm) 2D gradient noise in about [-1, 1]
+	float TerrainNoise(float x, float z, uint32_t seed, int octaves);
+
+	//Infinite height field split into square chunks around the camera.
+	//Chunks are generated on background threads from a createPlane grid displaced by the height function,
+	//and uploaded on the calling thread during update(). Distant chunks use coarser grids. Where a chunk meets a
+	//coarser neighbour, its edge vertices are moved onto the neighbour's edge, so the seams never crack.
+	//Chunk vertices are in world space: draw with an identity model matrix.
+	class Terrain {
+	public:
+		//heightFunction(x, z) must be thread safe. Empty uses TerrainNoise with the settings' seed and scales
+		Terrain(const TerrainSettings& settings = TerrainSettings(), std::function<float(float, float)> heightFunction = nullptr);
+		~Terrain();
+		Terrain(const Terrain&) = delete;
+		Terrain& operator=(const Terrain&) = delete;
+
+		//Uploads finished chunks, requests chunks and LOD changes around the camera, and unloads chunks left behind.
+		//Call once per frame on the thread that owns the OpenGL context
+		void update(const Camera& camera);
+		//Draws loaded chunks that intersect the frustum. Returns the number drawn
+		int draw(const ew::Mat4& viewProjection)const;
+		float getHeight(float x, float z)const { return m_heightFunction(x, z); }
+
+		inline const TerrainSettings& getSettings()const { return m_settings; }
+		inline int getNumLoadedChunks()const { return m_numLoaded; }
+		//Chunks being generated or waiting for upload
+		inline int getNumPendingChunks()const { return m_numPending + (int)m_uploadQueue.size(); }
+		inline size_t getMemoryUsage()const { return m_memoryUsage; }
+	private:
+		struct Chunk {
+			Mesh mesh;
+			uint32_t variant = 0; //LOD and neighbour LODs of the loaded mesh, see makeVariant
+			uint32_t pendingVariant = 0; //Requested and not uploaded yet. 0 = nothing requested
+			uint32_t queuedVariant = 0; //Generated and waiting in m_uploadQueue. 0 = nothing queued
+			bool loaded = false;
+			size_t bytes = 0;
+		};
+		struct GeneratedChunk {
+			uint64_t key;
+			uint32_t variant;
+			MeshData meshData;
+		};
+		//Shared with generator tasks, so finished work has somewhere to go even after the terrain is gone
+		struct Results {
+			std::mutex mutex;
+			std::vector<GeneratedChunk> chunks;
+			std::atomic<bool> cancelled{ false };
+		};
+
+		void requestChunk(int x, int z, uint32_t variant);
+		size_t estimateBytes(int lod)const;
+
+		TerrainSettings m_settings;
+		std::function<float(float, float)> m_heightFunction;
+		std::unordered_map<uint64_t, Chunk> m_chunks;
+		std::shared_ptr<Results> m_results;
+		std::vector<GeneratedChunk> m_uploadQueue;
+		int m_numLoaded = 0;
+		int m_numPending = 0;
+		size_t m_memoryUsage = 0;
+		//Declared last so it is destroyed first, joining the workers while the rest is still alive
+		ThreadPool m_pool;
+	};
+}
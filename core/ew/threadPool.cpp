@@ -0,0 +1,103 @@
+#include "threadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace ew {
+	ThreadPool::ThreadPool(unsigned int numThreads)
+	{
+		if (numThreads == 0)
+			numThreads = std::max(1u, std::thread::hardware_concurrency());
+		for (unsigned int i = 1; i < numThreads; i++)
+			m_workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopping = true;
+		}
+		m_condition.notify_all();
+		for (std::thread& worker : m_workers)
+			worker.join();
+	}
+	void ThreadPool::workerLoop()
+	{
+		while (true) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+				if (m_tasks.empty())
+					return;
+				task = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+			task();
+		}
+	}
+	void ThreadPool::submit(std::function<void()> task)
+	{
+		if (m_workers.empty()) {
+			task();
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_tasks.push_back(std::move(task));
+		}
+		m_condition.notify_one();
+	}
+	/// <summary>
+	/// Ranges are claimed from a shared counter by the calling thread and by one helper task per worker.
+	/// The caller only waits for ranges that were claimed, so helpers stuck behind other tasks cannot stall it;
+	/// they find nothing left when they start. The shared state outlives the call for that reason.
+	/// </summary>
+	/// <param name="count"></param>
+	/// <param name="grainSize">Items per range. Larger ranges mean less scheduling overhead</param>
+	/// <param name="fn"></param>
+	void ThreadPool::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& fn)
+	{
+		grainSize = std::max<size_t>(grainSize, 1);
+		const size_t numRanges = (count + grainSize - 1) / grainSize;
+		if (numRanges <= 1 || m_workers.empty()) {
+			if (count > 0)
+				fn(0, count);
+			return;
+		}
+		struct State {
+			std::atomic<size_t> next{ 0 };
+			size_t done = 0;
+			std::mutex mutex;
+			std::condition_variable condition;
+		};
+		std::shared_ptr<State> state = std::make_shared<State>();
+		//fn is only called for claimed ranges, which the caller waits on, so capturing it by pointer is safe
+		const std::function<void(size_t, size_t)>* function = &fn;
+		auto work = [state, function, count, grainSize, numRanges]() {
+			size_t finished = 0;
+			for (size_t range = state->next++; range < numRanges; range = state->next++) {
+				const size_t begin = range * grainSize;
+				(*function)(begin, std::min(begin + grainSize, count));
+				finished++;
+			}
+			if (finished > 0) {
+				std::lock_guard<std::mutex> lock(state->mutex);
+				state->done += finished;
+				if (state->done == numRanges)
+					state->condition.notify_all();
+			}
+		};
+		const size_t numHelpers = std::min(m_workers.size(), numRanges - 1);
+		for (size_t i = 0; i < numHelpers; i++)
+			submit(work);
+		work();
+		std::unique_lock<std::mutex> lock(state->mutex);
+		state->condition.wait(lock, [&] { return state->done == numRanges; });
+	}
+	ThreadPool& ThreadPool::getShared()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ew {
+	//Fixed set of worker threads fed from one task queue.
+	//numThreads counts the thread calling parallelFor, so a pool of 1 has no workers and runs everything inline.
+	class ThreadPool {
+	public:
+		//0 = one thread per hardware thread
+		explicit ThreadPool(unsigned int numThreads = 0);
+		//Finishes queued tasks, then joins the workers
+		~ThreadPool();
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		//Runs task on a worker. Without workers it runs immediately on the calling thread
+		void submit(std::function<void()> task);
+		//Calls fn(begin, end) over [0, count) in ranges of grainSize items, on the workers and the calling thread.
+		//Returns when every range is done. Safe to call while the workers are busy with submitted tasks.
+		void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& fn);
+
+		inline unsigned int getNumThreads()const { return (unsigned int)m_workers.size() + 1; }
+
+		//Process wide pool with one thread per hardware thread, created on first use
+		static ThreadPool& getShared();
+	private:
+		void workerLoop();
+
+		std::vector<std::thread> m_workers;
+		std::deque<std::function<void()>> m_tasks;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_stopping = false;
+	};
+}
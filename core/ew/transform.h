@@ -2,17 +2,67 @@
 #include "ewMath/ewMath.h"
 #include "ewMath/transformations.h"
 namespace ew {
+	//Position/rotation/scale with cached model and normal matrices.
+	//Matrices are only rebuilt after one of the setters has been called.
 	struct Transform {
-		ew::Vec3 position = ew::Vec3(0.0f, 0.0f, 0.0f);
-		ew::Vec3 rotation = ew::Vec3(0.0f, 0.0f, 0.0f); //Euler angles (Degrees)
-		ew::Vec3 scale = ew::Vec3(1.0f, 1.0f, 1.0f);
+		Transform() = default;
+		Transform(const ew::Vec3& position, const ew::Quat& rotation = ew::Quat(), const ew::Vec3& scale = ew::Vec3(1.0f))
+			:m_position(position), m_rotation(rotation), m_scale(scale) {}
 
-		ew::Mat4 getModelMatrix() const {
-			return ew::Translate(position)
-				* ew::RotateY(ew::Radians(rotation.y))
-				* ew::RotateX(ew::Radians(rotation.x))
-				* ew::RotateZ(ew::Radians(rotation.z))
-				* ew::Scale(scale);
+		inline const ew::Vec3& getPosition() const { return m_position; }
+		inline const ew::Quat& getRotation() const { return m_rotation; }
+		inline const ew::Vec3& getScale() const { return m_scale; }
+		//Euler angles (Degrees), same convention as ew::FromEuler
+		inline ew::Vec3 getEulerRotation() const { return ew::ToEuler(m_rotation) * ew::RAD2DEG; }
+
+		inline void setPosition(const ew::Vec3& position) {
+			m_position = position;
+			m_modelDirty = true;
+		}
+		inline void setRotation(const ew::Quat& rotation) {
+			m_rotation = rotation;
+			m_modelDirty = true;
+			m_normalDirty = true;
+		}
+		//Euler angles (Degrees)
+		inline void setEulerRotation(const ew::Vec3& rotation) {
+			setRotation(ew::FromEuler(rotation * ew::DEG2RAD));
+		}
+		//Applies an additional rotation on top of the current one
+		inline void rotate(const ew::Quat& rotation) {
+			setRotation(ew::Normalize(rotation * m_rotation));
+		}
+		inline void setScale(const ew::Vec3& scale) {
+			m_scale = scale;
+			m_modelDirty = true;
+			m_normalDirty = true;
 		}
+
+		const ew::Mat4& getModelMatrix() const {
+			if (m_modelDirty) {
+				m_modelMatrix = ew::TRS(m_position, m_rotation, m_scale);
+				m_modelDirty = false;
+			}
+			return m_modelMatrix;
+		}
+
+		//Inverse transpose of the model matrix, for transforming normals.
+		//Only depends on rotation and scale, so moving the transform does not invalidate it.
+		const ew::Mat4& getNormalMatrix() const {
+			if (m_normalDirty) {
+				m_normalMatrix = ew::NormalMatrix(getModelMatrix());
+				m_normalDirty = false;
+			}
+			return m_normalMatrix;
+		}
+	private:
+		ew::Vec3 m_position = ew::Vec3(0.0f, 0.0f, 0.0f);
+		ew::Quat m_rotation = ew::Quat();
+		ew::Vec3 m_scale = ew::Vec3(1.0f, 1.0f, 1.0f);
+
+		mutable ew::Mat4 m_modelMatrix;
+		mutable ew::Mat4 m_normalMatrix;
+		mutable bool m_modelDirty = true;
+		mutable bool m_normalDirty = true;
 	};
-}
+}
\ No newline at end of file